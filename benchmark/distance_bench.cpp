@@ -0,0 +1,59 @@
+#include "ais.hpp"
+#include "seq.hpp"
+#include "synthetic.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <vector>
+
+namespace {
+using seqmaker::bench::make_trajectory;
+
+void BM_scalar_dist(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> d(trajectory.size() - 1);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < d.size(); i++) {
+            d[i] = trajectory[i].x.dist_nm(trajectory[i + 1].x);
+        }
+        benchmark::DoNotOptimize(d.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename M> void BM_adjacent_dist(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> d(trajectory.size() - 1);
+    for (auto _ : state) {
+        seqmaker::ais::adjacent_dist<M>(trajectory, d);
+        benchmark::DoNotOptimize(d.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <seqmaker::ais::Metric METRIC> void BM_split(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    const seqmaker::split_args args{
+        .seq_length = 20, .dt_max = 25, .dti = 10, .ds_max = .1, .v_min = 1., .metric = METRIC};
+    for (auto _ : state) {
+        auto seqs = seqmaker::split(trajectory, args);
+        benchmark::DoNotOptimize(seqs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}   // namespace
+
+constexpr auto N_POSITIONS = 1000000;
+
+using seqmaker::ais::Equirectangular;
+using seqmaker::ais::Flat;
+using seqmaker::ais::Haversine;
+using seqmaker::ais::Metric;
+
+BENCHMARK(BM_scalar_dist)->Arg(N_POSITIONS);                              // NOLINT
+BENCHMARK_TEMPLATE(BM_adjacent_dist, Equirectangular)->Arg(N_POSITIONS);   // NOLINT
+BENCHMARK_TEMPLATE(BM_adjacent_dist, Haversine)->Arg(N_POSITIONS);         // NOLINT
+BENCHMARK_TEMPLATE(BM_adjacent_dist, Flat)->Arg(N_POSITIONS);              // NOLINT
+BENCHMARK_TEMPLATE(BM_split, Metric::equirectangular)->Arg(N_POSITIONS);   // NOLINT
+BENCHMARK_TEMPLATE(BM_split, Metric::haversine)->Arg(N_POSITIONS);         // NOLINT
+BENCHMARK_TEMPLATE(BM_split, Metric::flat)->Arg(N_POSITIONS);              // NOLINT
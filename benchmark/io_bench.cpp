@@ -0,0 +1,120 @@
+#include "io.hpp"
+#include "synthetic.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+[[nodiscard]] std::filesystem::path make_csv(std::size_t n_lines) {
+    auto path = std::filesystem::temp_directory_path()
+                / ("seqmaker_io_bench_" + std::to_string(n_lines) + ".csv");
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
+
+    std::ofstream f(path);
+    f << seqmaker::bench::make_csv(n_lines);
+
+    return path;
+}
+
+// the reader this library used before io::process_input_stream went block based
+template <typename F> void process_input_getc(std::FILE* stream, F&& f) {
+    constexpr auto BUFFER_SIZE = 1024U;
+    std::vector<char> buffer;
+    buffer.reserve(BUFFER_SIZE);
+
+    auto i = 0U;
+    for (int c = EOF; (c = std::getc(stream)) != EOF;) {
+        if (c == '\n') {
+            f(std::string_view(buffer.data(), i));
+            buffer.clear();
+            i = 0;
+        } else {
+            buffer.emplace_back(static_cast<char>(c));
+            i += 1;
+        }
+    }
+}
+
+void set_counters(benchmark::State& state, const std::filesystem::path& path) {
+    const auto n_bytes = static_cast<std::int64_t>(std::filesystem::file_size(path));
+    state.SetBytesProcessed(state.iterations() * n_bytes);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_getc_reader(benchmark::State& state) {
+    const auto path = make_csv(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::FILE* stream = std::fopen(path.c_str(), "r");   // NOLINT
+        std::size_t n = 0;
+        process_input_getc(stream, [&n](std::string_view line) { n += line.size(); });
+        std::fclose(stream);   // NOLINT
+        benchmark::DoNotOptimize(n);
+    }
+    set_counters(state, path);
+}
+
+void BM_mmap_reader(benchmark::State& state) {
+    const auto path = make_csv(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::size_t n = 0;
+        seqmaker::io::process_input_file(path, [&n](std::string_view line) { n += line.size(); });
+        benchmark::DoNotOptimize(n);
+    }
+    set_counters(state, path);
+}
+
+void BM_block_reader(benchmark::State& state) {
+    const auto path = make_csv(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        const seqmaker::io::detail::FileDescriptor fd{path};
+        std::size_t n = 0;
+        auto count = [&n](std::string_view line) { n += line.size(); };
+        auto lines = [&count](std::string_view block) {
+            seqmaker::io::detail::for_each_line(block, count);
+        };
+        seqmaker::io::detail::read_blocks(fd.get(), lines, seqmaker::io::DEFAULT_BLOCK_SIZE);
+        benchmark::DoNotOptimize(n);
+    }
+    set_counters(state, path);
+}
+
+// reads the file from standard input, which is redirected to the file for the benchmark
+void BM_stream_reader(benchmark::State& state) {
+    const auto path = make_csv(static_cast<std::size_t>(state.range(0)));
+    const seqmaker::io::detail::FileDescriptor fd{path};
+    const auto stdin_fd = dup(STDIN_FILENO);
+    if (stdin_fd < 0 or dup2(fd.get(), STDIN_FILENO) < 0) {
+        state.SkipWithError(std::error_code(errno, std::generic_category()).message().c_str());
+        return;
+    }
+
+    for (auto _ : state) {
+        lseek(STDIN_FILENO, 0, SEEK_SET);
+        std::size_t n = 0;
+        seqmaker::io::process_input_stream([&n](std::string_view line) { n += line.size(); });
+        benchmark::DoNotOptimize(n);
+    }
+    set_counters(state, path);
+
+    dup2(stdin_fd, STDIN_FILENO);
+    close(stdin_fd);
+}
+}   // namespace
+
+constexpr auto N_LINES = 1000000;
+
+BENCHMARK(BM_getc_reader)->Arg(N_LINES)->Unit(benchmark::kMillisecond);    // NOLINT
+BENCHMARK(BM_mmap_reader)->Arg(N_LINES)->Unit(benchmark::kMillisecond);    // NOLINT
+BENCHMARK(BM_block_reader)->Arg(N_LINES)->Unit(benchmark::kMillisecond);   // NOLINT
+BENCHMARK(BM_stream_reader)->Arg(N_LINES)->Unit(benchmark::kMillisecond);  // NOLINT
@@ -0,0 +1,80 @@
+#include "ais.hpp"
+#include "mmsi_map.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/*
+ * MMSIs of n positions from n_vessels vessels with random MMSIs, where the number of positions per
+ * vessel follows a heavy-tailed (Zipf-like) distribution as in real AIS data.
+ */
+[[nodiscard]] std::vector<seqmaker::ais::mmsi_t> make_mmsis(std::size_t n, std::size_t n_vessels) {
+    using seqmaker::ais::mmsi_t;
+
+    std::mt19937 g(0);                                                 // NOLINT
+    std::uniform_int_distribution<mmsi_t> mmsi(200000000, 799999999);     // NOLINT
+
+    std::vector<mmsi_t> vessels(n_vessels);
+    std::vector<double> weights(n_vessels);
+    for (std::size_t i = 0; i < n_vessels; i++) {
+        vessels[i] = mmsi(g);
+        weights[i] = 1. / std::pow(static_cast<double>(i + 1), .8);   // NOLINT
+    }
+
+    std::discrete_distribution<std::size_t> vessel(weights.begin(), weights.end());
+    std::vector<mmsi_t> mmsis(n);
+    for (auto& x : mmsis) {
+        x = vessels[vessel(g)];
+    }
+    return mmsis;
+}
+
+void BM_unordered_map(benchmark::State& state) {
+    const auto mmsis = make_mmsis(static_cast<std::size_t>(state.range(0)),
+                                  static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        std::unordered_map<seqmaker::ais::mmsi_t, std::size_t> map;
+        for (auto x : mmsis) {
+            map[x]++;
+        }
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_mmsi_map(benchmark::State& state) {
+    const auto mmsis = make_mmsis(static_cast<std::size_t>(state.range(0)),
+                                  static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        seqmaker::MmsiMap<std::size_t> map;
+        for (auto x : mmsis) {
+            map.find_or_insert(x).first++;
+        }
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_mmsi_map_batched(benchmark::State& state) {
+    const auto mmsis = make_mmsis(static_cast<std::size_t>(state.range(0)),
+                                  static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        seqmaker::MmsiMap<std::size_t> map;
+        map.find_or_insert(
+            mmsis, [](auto x) { return x; }, [](auto, std::size_t& n, bool) { n++; });
+        benchmark::DoNotOptimize(map.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}   // namespace
+
+constexpr auto N_MMSIS = 1000000;
+
+BENCHMARK(BM_unordered_map)->Args({N_MMSIS, 1000})->Args({N_MMSIS, 100000});      // NOLINT
+BENCHMARK(BM_mmsi_map)->Args({N_MMSIS, 1000})->Args({N_MMSIS, 100000});           // NOLINT
+BENCHMARK(BM_mmsi_map_batched)->Args({N_MMSIS, 1000})->Args({N_MMSIS, 100000});   // NOLINT
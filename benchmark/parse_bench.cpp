@@ -0,0 +1,84 @@
+#include "ais.hpp"
+#include "io.hpp"
+#include "parse.hpp"
+#include "synthetic.hpp"
+#include "utility.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+[[nodiscard]] std::vector<std::string_view> split_lines(std::string_view csv) {
+    std::vector<std::string_view> lines;
+    auto add = [&lines](std::string_view line) { lines.emplace_back(line); };
+    seqmaker::io::detail::for_each_line(csv, add);
+    return lines;
+}
+
+void set_counters(benchmark::State& state, std::string_view csv) {
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(csv.size()));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_split_map(benchmark::State& state) {
+    const auto csv = seqmaker::bench::make_csv(static_cast<std::size_t>(state.range(0)));
+    const auto lines = split_lines(csv);
+    for (auto _ : state) {
+        std::size_t n = 0;
+        for (auto line : lines) {
+            n += seqmaker::utility::split_map(
+                line,
+                ", ",
+                [](std::string_view t,
+                   std::string_view mmsi,
+                   std::string_view slot,
+                   std::string_view lat,
+                   std::string_view lon) {
+                    return t.size() + mmsi.size() + slot.size() + lat.size() + lon.size();
+                });
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    set_counters(state, csv);
+}
+
+void BM_time_recorded(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<std::string> recv(n);
+    std::vector<std::string> slot(n);
+    for (std::size_t i = 0; i < n; i++) {
+        constexpr auto T0 = 1456786800U;
+        recv[i] = std::to_string(T0 + i) + ".005";
+        slot[i] = std::to_string(i % 60);   // NOLINT
+    }
+
+    for (auto _ : state) {
+        seqmaker::ais::time_t sum = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            sum += seqmaker::utility::time_recorded<seqmaker::ais::time_t>(recv[i], slot[i])
+                       .value_or(0);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_parse_ais_lines(benchmark::State& state) {
+    const auto csv = seqmaker::bench::make_csv(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto batch = seqmaker::parse_ais_lines(csv, ", ");
+        benchmark::DoNotOptimize(batch.data());
+    }
+    set_counters(state, csv);
+}
+}   // namespace
+
+constexpr auto N_LINES = 1000000;
+
+BENCHMARK(BM_split_map)->Arg(N_LINES)->Unit(benchmark::kMillisecond);         // NOLINT
+BENCHMARK(BM_time_recorded)->Arg(N_LINES)->Unit(benchmark::kMillisecond);     // NOLINT
+BENCHMARK(BM_parse_ais_lines)->Arg(N_LINES)->Unit(benchmark::kMillisecond);   // NOLINT
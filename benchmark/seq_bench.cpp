@@ -0,0 +1,138 @@
+#include "ais.hpp"
+#include "seq.hpp"
+#include "seq_diff.hpp"
+#include "seq_maker.hpp"
+#include "synthetic.hpp"
+#include "utility.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <vector>
+
+namespace {
+using seqmaker::bench::make_trajectory;
+
+const seqmaker::split_args ARGS{.seq_length = 20,
+                                .dt_max = 25,
+                                .dti = 10,
+                                .ds_max = .1,
+                                .v_min = 1.,
+                                .metric = seqmaker::ais::Metric::equirectangular};
+
+void BM_point_interpolate(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    std::vector<seqmaker::ais::Point> points(trajectory.size() - 1);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < points.size(); i++) {
+            points[i] = trajectory[i].x.interpolate(trajectory[i + 1].x, .3);   // NOLINT
+        }
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_interpolate(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+
+    // grid points every dt seconds over the whole trajectory
+    constexpr auto DT = 10U;
+    const auto n_grid_points = (trajectory.back().t - trajectory.front().t) / DT + 1;
+    for (auto _ : state) {
+        auto points = seqmaker::interpolate(trajectory, n_grid_points, DT);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n_grid_points);
+}
+
+void BM_drop_rate(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    seqmaker::SplitBuffers buffers;
+    for (auto _ : state) {
+        auto rate = seqmaker::drop_rate(trajectory, ARGS, buffers);
+        benchmark::DoNotOptimize(rate);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_low_pass_filter(benchmark::State& state) {
+    const auto trajectory = make_trajectory(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> ds(trajectory.size() - 1);
+    seqmaker::ais::adjacent_dist(ARGS.metric, trajectory, ds);
+    const auto ds_max = seqmaker::ais::from_nm(ARGS.metric, ARGS.ds_max);
+
+    // as in Sequencer::low_pass_filter, pairs are judged by the precomputed distances
+    auto is_valid = [&ds, first = trajectory.data(), ds_max](const auto& a, const auto&) {
+        return ds[static_cast<std::size_t>(&a - first)] <= ds_max;
+    };
+
+    std::vector<seqmaker::ais::Position> out(trajectory.size());
+    for (auto _ : state) {
+        auto last = seqmaker::utility::low_pass_filter(
+            trajectory.begin(), trajectory.end(), out.begin(), is_valid);
+        benchmark::DoNotOptimize(last);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/*
+ * In-memory dataset of range(0) positions that are evenly distributed over range(1) vessels.
+ */
+template <typename S> void add_trajectories(benchmark::State& state, S& sequencer) {
+    const auto n_vessels = static_cast<std::size_t>(state.range(1));
+    const auto n = static_cast<std::size_t>(state.range(0)) / n_vessels;
+    for (std::size_t i = 0; i < n_vessels; i++) {
+        constexpr seqmaker::ais::mmsi_t MMSI0 = 200000000;
+        sequencer.add_trajectory(MMSI0 + static_cast<seqmaker::ais::mmsi_t>(i),
+                                 make_trajectory(n, static_cast<unsigned>(i)));
+    }
+}
+
+void BM_sequence_maker(benchmark::State& state) {
+    const auto n_threads = static_cast<unsigned>(state.range(2));
+    for (auto _ : state) {
+        state.PauseTiming();
+        seqmaker::SequenceMaker seq_maker{ARGS, "", n_threads};
+        add_trajectories(state, seq_maker);
+        state.ResumeTiming();
+
+        auto seqs = seq_maker.run(true);
+        benchmark::DoNotOptimize(seqs.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_sequence_diff(benchmark::State& state) {
+    const auto n_threads = static_cast<unsigned>(state.range(2));
+    for (auto _ : state) {
+        state.PauseTiming();
+        seqmaker::SequenceDiff seq_diff{
+            seqmaker::input_args{.delimiter = "", .n_threads = n_threads}};
+        add_trajectories(state, seq_diff);
+        state.ResumeTiming();
+
+        auto diffs = seq_diff.run(1);
+        benchmark::DoNotOptimize(diffs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}   // namespace
+
+constexpr auto N_POSITIONS = 1000000;
+constexpr auto N_VESSELS = 1000;
+
+BENCHMARK(BM_point_interpolate)->Arg(N_POSITIONS);   // NOLINT
+BENCHMARK(BM_interpolate)->Arg(N_POSITIONS);         // NOLINT
+BENCHMARK(BM_drop_rate)->Arg(N_POSITIONS);           // NOLINT
+BENCHMARK(BM_low_pass_filter)->Arg(N_POSITIONS);     // NOLINT
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_sequence_maker)
+    ->ArgsProduct({{N_POSITIONS}, {N_VESSELS}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE
+BENCHMARK(BM_sequence_diff)
+    ->ArgsProduct({{N_POSITIONS}, {N_VESSELS}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
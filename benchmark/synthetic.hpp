@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ais.hpp"
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace seqmaker::bench {
+/*
+ * Random walk of n positions with time steps of 1 to 30 seconds, where the seed selects the walk.
+ */
+[[nodiscard]] inline ais::Trajectory make_trajectory(std::size_t n, unsigned seed = 0) {
+    using ais::Point;
+
+    std::mt19937 g(seed);
+    std::uniform_int_distribution<Point::value_type> step(-500, 500);   // NOLINT
+    std::uniform_int_distribution<ais::time_t> dt(1, 30);               // NOLINT
+
+    ais::Trajectory trajectory;
+    trajectory.reserve(n);
+
+    constexpr auto T0 = 1456786800U;
+    ais::Position pos{.t = T0, .x = Point{.latitude = 31200000, .longitude = 7800000}};
+    for (std::size_t i = 0; i < n; i++) {
+        pos.t += dt(g);
+        pos.x.latitude += step(g);
+        pos.x.longitude += step(g);
+        trajectory.emplace_back(pos);
+    }
+
+    return trajectory;
+}
+
+/*
+ * n_lines lines of AIS data in the input format of seqmaker, with random MMSIs and positions and
+ * a few trailing columns that are not parsed.
+ */
+[[nodiscard]] inline std::string make_csv(std::size_t n_lines) {
+    std::mt19937 g(0);                                                 // NOLINT
+    std::uniform_int_distribution<int> mmsi(200000000, 799999999);   // NOLINT
+    std::uniform_int_distribution<int> pos(-50000000, 50000000);     // NOLINT
+
+    std::string csv;
+    for (std::size_t i = 0; i < n_lines; i++) {
+        constexpr auto T0 = 1456786800U;
+        const auto id = mmsi(g);
+        const auto lat = pos(g);
+        const auto lon = pos(g);
+        csv += std::to_string(T0 + i) + ".005, " + std::to_string(id) + ", "
+               + std::to_string(i % 60) + ", " + std::to_string(lat) + ", "   // NOLINT
+               + std::to_string(lon) + ", some, more, columns\n";
+    }
+
+    return csv;
+}
+}   // namespace seqmaker::bench
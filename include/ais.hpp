@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace seqmaker::ais {
@@ -30,11 +36,125 @@ struct Position final {
 
 using Trajectory = std::vector<Position>;
 
+using TrajectoryView = std::span<const Position>;
+
 [[nodiscard]] constexpr bool is_valid_mmsi(mmsi_t mmsi) noexcept {
     constexpr mmsi_t MIN_MMSI = 200000000;
     constexpr mmsi_t MAX_MMSI = 799999999;
     return mmsi >= MIN_MMSI and mmsi <= MAX_MMSI;
 }
 
-[[nodiscard]] double acc_dist_nm(const std::vector<Point>& /* points */) noexcept;
+/*
+ * Distance metrics, where distances are given in nautical miles except for the flat metric. The
+ * latter yields squared distances of the equirectangular approximation, which saves the square
+ * root wherever distances are only compared against thresholds.
+ */
+enum class Metric { equirectangular, haversine, flat };
+
+/*
+ * Distance policies of the metrics. Each policy provides the distance dist(a, b) of two points in
+ * the unit of its metric and the conversions of distances from and to nautical miles. The
+ * distances are identical to the ones of adjacent_dist, i.e., thresholds are applied alike by
+ * streaming and batched processing.
+ */
+struct Equirectangular {
+    [[nodiscard]] static double dist(Point /* a */, Point /* b */) noexcept;
+
+    [[nodiscard]] static constexpr double from_nm(double d) noexcept {
+        return d;
+    }
+
+    [[nodiscard]] static constexpr double to_nm(double d) noexcept {
+        return d;
+    }
+};
+
+struct Haversine {
+    [[nodiscard]] static double dist(Point /* a */, Point /* b */) noexcept;
+
+    [[nodiscard]] static constexpr double from_nm(double d) noexcept {
+        return d;
+    }
+
+    [[nodiscard]] static constexpr double to_nm(double d) noexcept {
+        return d;
+    }
+};
+
+struct Flat {
+    [[nodiscard]] static double dist(Point /* a */, Point /* b */) noexcept;
+
+    [[nodiscard]] static constexpr double from_nm(double d) noexcept {
+        return d * d;
+    }
+
+    [[nodiscard]] static double to_nm(double d) noexcept {
+        return std::sqrt(d);
+    }
+};
+
+/*
+ * Calls f with the distance policy of the given metric, i.e., f is instantiated for each policy.
+ */
+template <typename F> decltype(auto) with_metric(Metric metric, F&& f) {
+    switch (metric) {
+    case Metric::haversine:
+        return f(Haversine{});
+    case Metric::flat:
+        return f(Flat{});
+    case Metric::equirectangular:
+        break;
+    }
+    return f(Equirectangular{});
+}
+
+/*
+ * Metric of the given name, i.e., "equirectangular", "haversine" or "flat".
+ */
+[[nodiscard]] std::optional<Metric> to_metric(std::string_view /* name */) noexcept;
+
+[[nodiscard]] std::string_view to_string(Metric /* metric */) noexcept;
+
+[[nodiscard]] inline double dist(Metric metric, Point a, Point b) noexcept {
+    return with_metric(metric, [a, b](auto m) { return decltype(m)::dist(a, b); });
+}
+
+[[nodiscard]] inline double from_nm(Metric metric, double d) noexcept {
+    return with_metric(metric, [d](auto m) { return decltype(m)::from_nm(d); });
+}
+
+/*
+ * Batched form of M::dist, where out[i] is the distance between the points i and (i + stride) for
+ * all i in [0, size - stride). For the equirectangular and the flat metric, the cosine of the mean
+ * latitude is approximated by a polynomial with an absolute error below 1e-8 and the distances are
+ * computed with AVX-512 or AVX2 if the target supports it.
+ */
+template <typename M>
+void adjacent_dist(std::span<const Point> /* points */,
+                   std::span<double> /* out */,
+                   std::size_t stride = 1) noexcept;
+
+template <typename M>
+void adjacent_dist(TrajectoryView /* trajectory */,
+                   std::span<double> /* out */,
+                   std::size_t stride = 1) noexcept;
+
+/*
+ * Dispatches to adjacent_dist with the distance policy of the given metric.
+ */
+inline void adjacent_dist(Metric metric,
+                          TrajectoryView trajectory,
+                          std::span<double> out,
+                          std::size_t stride = 1) noexcept {
+    with_metric(metric, [=](auto m) { adjacent_dist<decltype(m)>(trajectory, out, stride); });
+}
+
+/*
+ * Accumulated distance of adjacent points in nautical miles. The summation stops early once the
+ * partial sum reaches limit, i.e., the result is either the total distance or at least limit.
+ */
+template <typename M = Equirectangular>
+[[nodiscard]] double
+acc_dist_nm(std::span<const Point> /* points */,
+            double limit = std::numeric_limits<double>::infinity()) noexcept;
 }   // namespace seqmaker::ais
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ais.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace seqmaker::gen {
+struct gen_args {
+    std::uint64_t n_positions = 1000000;   // NOLINT
+    std::size_t n_vessels = 1000;          // NOLINT
+    std::uint64_t seed = 0;                // NOLINT
+    unsigned days = 30;                    // NOLINT
+    std::string delimiter = ", ";          // NOLINT
+
+    // fraction of moored vessels, which report every 3 minutes close to their anchor position
+    double moored = .3;   // NOLINT
+
+    // report intervals in seconds of underway vessels, each vessel picks one of them at random
+    std::vector<unsigned> rates = {2, 6, 10, 30};   // NOLINT
+
+    // shape of the Pareto distribution of the number of positions per vessel
+    double alpha = 1.5;   // NOLINT
+
+    // upper bound of the delay in seconds between the slot second and the reception of a report
+    double jitter = 2.;   // NOLINT
+
+    // probabilities per report of a duplicate reception, of a gap of more than dt_max seconds
+    // before the report, of a position jump of more than ds_max, and of an invalid row
+    double p_duplicate = .01;   // NOLINT
+    double p_gap = .001;        // NOLINT
+    double p_jump = .001;       // NOLINT
+    double p_invalid = .001;    // NOLINT
+
+    unsigned dt_max = 60;   // NOLINT
+    double ds_max = .1;     // NOLINT
+};
+
+/*
+ * Deterministic generator of synthetic AIS data, i.e., the output only depends on the arguments
+ * including the seed. Vessels draw their number of valid positions from a heavy-tailed
+ * distribution, such that their total is n_positions, and start at random times within the given
+ * number of days, where no vessel reports more than once per second. Underway vessels move at
+ * constant speed along a slowly turning course, moored ones scatter around their anchor position.
+ *
+ * On top of the valid positions, there are duplicate receptions (same slot second and position,
+ * but another reception time) and invalid rows (invalid MMSI, position, slot second, or reception
+ * time), which are all dropped by the parser. Gaps and position jumps are valid positions.
+ *
+ * Each vessel has a random stream of its own, which is implemented here instead of using the
+ * distributions of the standard library, whose results differ between implementations.
+ */
+class Generator {
+  public:
+    using Sink = std::function<void(std::string_view)>;
+
+    struct Vessel {
+        ais::mmsi_t mmsi;       // NOLINT
+        std::uint64_t n;        // NOLINT // number of valid positions
+        ais::time_t start;      // NOLINT
+        unsigned interval;      // NOLINT // seconds between reports
+        bool moored;            // NOLINT
+    };
+
+  private:
+    gen_args args_;
+    std::vector<Vessel> vessels_;   // in ascending order of MMSIs
+
+  public:
+    /*
+     * Throws std::invalid_argument if any argument is out of range or if n_positions exceeds one
+     * position per second and vessel within the given days.
+     */
+    explicit Generator(gen_args /* args */);
+
+    [[nodiscard]] const std::vector<Vessel>& vessels() const noexcept {
+        return vessels_;
+    }
+
+    /*
+     * Passes lines of AIS data in the input format of seqmaker in chunks to the sink, where the
+     * lines are ordered by the slot-corrected time of their reports.
+     */
+    void write_csv(const Sink& /* sink */) const;
+
+    /*
+     * Writes the valid positions to a trajectory cache file (cf. TrajectoryCache), which equals
+     * the one that seqmaker --build-cache writes for the lines of write_csv.
+     */
+    void write_cache(const std::filesystem::path& /* path */) const;
+};
+}   // namespace seqmaker::gen
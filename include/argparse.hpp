@@ -5,11 +5,13 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace argparse {
 class Argparse {
   private:
     std::unordered_map<std::string, std::string> args_;
+    std::unordered_map<std::string, std::vector<std::string>> values_;   // of repeated arguments
 
   public:
     Argparse(int argc, const char** argv) noexcept {
@@ -22,6 +24,7 @@ class Argparse {
                     last_arg = arg;
                 } else if (not last_arg.empty()) {
                     args_.insert_or_assign(last_arg, arg);
+                    values_[last_arg].emplace_back(arg);
                     last_arg.clear();
                 }
             }
@@ -43,6 +46,16 @@ class Argparse {
         return std::nullopt;
     }
 
+    /*
+     * Values of all occurrences of the argument in order, whereas get yields the last one.
+     */
+    [[nodiscard]] std::vector<std::string> get_all(std::string_view arg) const {
+        if (auto it = values_.find(std::string{arg}); it != values_.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
     template <typename T>
     [[nodiscard]] std::optional<std::string> check_args(const T& valid_args) const noexcept {
         for (auto [k, v] : args_) {
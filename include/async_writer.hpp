@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace seqmaker::io {
+/*
+ * Writes buffers to files on background threads, such that output is written while further
+ * results are computed. Each file is assigned to a fixed writer thread by a hash of its path,
+ * i.e., writes to a common file are carried out in the order they were issued.
+ *
+ * Memory is bounded by the capacity: write blocks while the queued buffers would exceed it (a
+ * single buffer is always accepted). Errors of the writer threads are rethrown by finish, where
+ * all writes after the first error are skipped.
+ */
+class AsyncWriter {
+  public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1U << 26U;   // 64 MiB
+
+  private:
+    struct Job {
+        std::filesystem::path path;
+        std::vector<char> bytes;
+        std::ios::openmode mode;
+    };
+
+    struct Queue {
+        std::deque<Job> jobs;
+        std::condition_variable ready;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable space_;   // signalled whenever a job is done
+    std::vector<Queue> queues_;       // one per writer thread
+    std::vector<std::thread> threads_;
+    std::size_t capacity_;
+    std::size_t n_queued_ = 0;   // bytes
+    bool done_ = false;
+    std::exception_ptr error_;
+
+    void drain(Queue& /* queue */) noexcept;
+
+  public:
+    explicit AsyncWriter(unsigned /* n_threads */, std::size_t /* capacity */ = DEFAULT_CAPACITY);
+
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+
+    AsyncWriter(AsyncWriter&&) = delete;
+
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    AsyncWriter& operator=(AsyncWriter&&) = delete;
+
+    /*
+     * Queues the bytes to be written to the file, which is truncated or appended to depending on
+     * mode. Blocks while the queue is full. Can be called concurrently.
+     */
+    void write(std::filesystem::path /* path */,
+               std::vector<char> /* bytes */,
+               std::ios::openmode /* mode */ = std::ios::trunc);
+
+    /*
+     * Waits until all queued bytes are written and stops the writer threads. Throws the first
+     * error of any writer thread, if any.
+     */
+    void finish();
+};
+}   // namespace seqmaker::io
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <sys/stat.h>
+
+namespace seqmaker::io {
+/*
+ * Helpers of the binary file formats, i.e., pack files and trajectory caches, whose sections start
+ * at multiples of a cache line.
+ */
+constexpr std::uint64_t ALIGNMENT = 64;
+
+[[nodiscard]] constexpr std::uint64_t align(std::uint64_t offset) noexcept {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+[[nodiscard]] inline std::size_t file_size(int fd, const std::filesystem::path& path) {
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+    return static_cast<std::size_t>(st.st_size);
+}
+
+/*
+ * Error of a corrupted file of the given kind, e.g., "pack file".
+ */
+[[nodiscard]] inline std::invalid_argument invalid_file(std::string_view kind,
+                                                       const std::filesystem::path& path,
+                                                       std::string_view reason) {
+    return std::invalid_argument("Invalid " + std::string{kind} + ' ' + path.string() + ". "
+                                 + std::string{reason});
+}
+
+/*
+ * Writes the sections of a binary file one after another, where each section is padded with zeros
+ * to its offset. Throws std::system_error on failure.
+ */
+class BinaryWriter {
+  private:
+    std::filesystem::path path_;
+    std::ofstream f_;
+    std::uint64_t n_written_ = 0;   // bytes
+
+  public:
+    explicit BinaryWriter(std::filesystem::path path)
+        : path_(std::move(path))
+        , f_(path_, std::ios::binary | std::ios::trunc) {
+        if (not f_) {
+            throw std::system_error(errno, std::generic_category(), path_.string());
+        }
+    }
+
+    void put(const void* data, std::size_t n) {
+        if (not f_.write(static_cast<const char*>(data), static_cast<std::streamsize>(n))) {
+            throw std::system_error(errno, std::generic_category(), path_.string());
+        }
+        n_written_ += n;
+    }
+
+    void pad(std::uint64_t offset) {
+        constexpr std::array<char, ALIGNMENT> zeros{};
+        put(zeros.data(), offset - n_written_);
+    }
+
+    void flush() {
+        if (not f_.flush()) {
+            throw std::system_error(errno, std::generic_category(), path_.string());
+        }
+    }
+
+    [[nodiscard]] std::uint64_t n_written() const noexcept {
+        return n_written_;
+    }
+};
+}   // namespace seqmaker::io
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace seqmaker::codec {
+/*
+ * Output formats of seqmaker and seqdiff: raw .bin files or packed files of the same rows.
+ */
+enum class Format { raw, packed };
+
+/*
+ * Format of the given name, i.e., "raw" or "packed".
+ */
+[[nodiscard]] std::optional<Format> to_format(std::string_view /* name */) noexcept;
+
+[[nodiscard]] std::string_view to_string(Format /* format */) noexcept;
+
+/*
+ * File extension of the given format, i.e., ".bin" or ".pbin".
+ */
+[[nodiscard]] std::string_view extension(Format /* format */) noexcept;
+
+/*
+ * Packed rows of 32 bit integers. A packed stream is a concatenation of frames, each of which is
+ * decoded independently, such that frames can be appended to a file:
+ *
+ *  header  magic "AISZ", format version, number of columns, flags (bit 0: delta encoding) and one
+ *          reserved byte, followed by the number of rows (unsigned 32 bit integer)
+ *  first   the first row as is
+ *  blocks  the remaining rows in blocks of BLOCK_SIZE rows (the last block may be shorter), where
+ *          each column of a block is stored as its bit width (one byte) followed by its values
+ *          bit-packed at this width in little-endian bit order
+ *
+ * Values are the zigzag-encoded differences of consecutive rows of a column if the frame is delta
+ * encoded and zigzag-encoded values otherwise. The header and the first row are in native byte
+ * order.
+ */
+inline constexpr std::uint8_t VERSION = 1;
+inline constexpr std::size_t BLOCK_SIZE = 128;
+
+[[nodiscard]] constexpr std::uint32_t zigzag(std::uint32_t x) noexcept {
+    return (x << 1U) ^ (0U - (x >> 31U));
+}
+
+[[nodiscard]] constexpr std::uint32_t unzigzag(std::uint32_t x) noexcept {
+    return (x >> 1U) ^ (0U - (x & 1U));
+}
+
+/*
+ * Appends the given rows of n_columns values each as one or more frames to out. Signed values are
+ * passed as their two's complement, e.g., by a static_cast.
+ */
+void encode(std::span<const std::uint32_t> /* rows */,
+            unsigned /* n_columns */,
+            bool /* delta */,
+            std::vector<char>& /* out */);
+
+/*
+ * Decodes all frames of a packed stream into the concatenation of their rows. The number of
+ * columns has to agree between frames. Throws std::invalid_argument if the stream is corrupted.
+ */
+[[nodiscard]] std::vector<std::uint32_t> decode(std::span<const char> /* bytes */);
+
+/*
+ * Decodes the given packed file, cf. decode.
+ */
+[[nodiscard]] std::vector<std::uint32_t> decode_file(const std::filesystem::path& /* path */);
+
+namespace detail {
+    /*
+     * Unpacks values of width bits each that are stored back to back starting at the least
+     * significant bit, where bytes has to be readable up to 8 bytes past the packed values. Values
+     * of up to 25 bits are gathered eight at a time if AVX2 is available.
+     */
+    void unpack(const char* /* bytes */,
+                unsigned /* width */,
+                std::span<std::uint32_t> /* values */) noexcept;
+
+    /*
+     * Scalar reference of unpack.
+     */
+    void unpack_scalar(const char* /* bytes */,
+                       unsigned /* width */,
+                       std::span<std::uint32_t> /* values */) noexcept;
+}   // namespace detail
+}   // namespace seqmaker::codec
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Binning of an axis into n_bins bins of equal width in [min, max), or of equal width in log(x)
+ * if the axis is logarithmic. Bin 0 counts values below min (or NaN) and bin n_bins + 1 values of
+ * at least max, i.e., there are n_bins + 2 bins in total.
+ */
+class Axis {
+  private:
+    double min_;
+    double max_;
+    unsigned n_bins_;
+    bool log_;
+    double offset_;   // min or log(min)
+    double scale_;    // bins per unit of x or log(x)
+
+  public:
+    /*
+     * Requires min < max, n_bins > 0 and, for a logarithmic axis, min > 0.
+     */
+    Axis(double /* min */, double /* max */, unsigned /* n_bins */, bool /* log */) noexcept;
+
+    [[nodiscard]] unsigned n_bins() const noexcept {
+        return n_bins_;
+    }
+
+    [[nodiscard]] bool is_log() const noexcept {
+        return log_;
+    }
+
+    [[nodiscard]] std::size_t bin(double /* x */) const noexcept;
+
+    /*
+     * Lower edge of bin i, i.e., -inf for bin 0 and min for bin 1, where edge(n_bins + 2) is inf.
+     */
+    [[nodiscard]] double edge(std::size_t /* i */) const noexcept;
+};
+
+/*
+ * Axis of the form "min,max,n_bins" or "min,max,n_bins,log", if any.
+ */
+[[nodiscard]] std::optional<Axis> to_axis(std::string_view /* spec */) noexcept;
+
+/*
+ * Counts of pairs (x, y) in the bins of two axes including under- and overflow bins.
+ */
+class Histogram2D {
+  private:
+    Axis x_;
+    Axis y_;
+    std::vector<std::uint64_t> counts_;
+
+  public:
+    Histogram2D(Axis x, Axis y)
+        : x_(x)
+        , y_(y)
+        , counts_((x.n_bins() + std::size_t{2}) * (y.n_bins() + std::size_t{2}), 0) {
+    }
+
+    [[nodiscard]] const Axis& x() const noexcept {
+        return x_;
+    }
+
+    [[nodiscard]] const Axis& y() const noexcept {
+        return y_;
+    }
+
+    void fill(double x, double y) noexcept {
+        counts_[x_.bin(x) * (y_.n_bins() + std::size_t{2}) + y_.bin(y)]++;
+    }
+
+    [[nodiscard]] std::uint64_t count(std::size_t i, std::size_t j) const noexcept {
+        return counts_[i * (y_.n_bins() + std::size_t{2}) + j];
+    }
+
+    /*
+     * Adds the counts of another histogram with the same axes.
+     */
+    void merge(const Histogram2D& /* other */) noexcept;
+};
+}   // namespace seqmaker
@@ -0,0 +1,15 @@
+#pragma once
+
+// x86 intrinsics of the SIMD code paths, which are enabled by the target architecture (cf. ARCH)
+#if defined(__AVX2__)
+#if defined(__GNUC__) && not defined(__clang__)
+// GCC 12 warns about the self-initialized placeholders of the AVX-512 intrinsics without
+// optimization
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#include <immintrin.h>
+#endif
+#endif
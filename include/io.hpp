@@ -1,25 +1,284 @@
 #pragma once
 
-#include <cstdio>
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace seqmaker::io {
-template <typename F> void process_input_stream(F&& f) {
-    constexpr auto BUFFER_SIZE = 1024U;
-    std::vector<char> buffer;
-    buffer.reserve(BUFFER_SIZE);
-
-    auto i = 0U;
-    for (int c = EOF; (c = std::getchar()) != EOF;) {
-        if (c == '\n') {
-            f(std::string_view(&buffer[0], i));
-            buffer.clear();
-            i = 0;
-        } else {
-            buffer.emplace_back(static_cast<char>(c));
-            i += 1;
+namespace detail {
+    [[nodiscard]] inline std::string_view strip_cr(std::string_view line) noexcept {
+        if (not line.empty() and line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    /*
+     * Calls f for each line of the block. The last line of the block does not need to be
+     * terminated by a newline.
+     */
+    template <typename F> void for_each_line(std::string_view block, F& f) {
+        std::size_t first = 0;
+        for (auto last = block.find('\n'); last != std::string_view::npos;
+             last = block.find('\n', first)) {
+            f(strip_cr(block.substr(first, last - first)));
+            first = last + 1;
+        }
+
+        if (first < block.size()) {
+            f(strip_cr(block.substr(first)));
         }
     }
+
+    class FileDescriptor {
+      private:
+        int fd_ = -1;
+
+      public:
+        explicit FileDescriptor(const std::filesystem::path& path)
+            : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {   // NOLINT
+            if (fd_ < 0) {
+                throw std::system_error(errno, std::generic_category(), path.string());
+            }
+        }
+
+        ~FileDescriptor() {
+            ::close(fd_);
+        }
+
+        FileDescriptor(const FileDescriptor&) = delete;
+
+        FileDescriptor(FileDescriptor&&) = delete;
+
+        FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+        FileDescriptor& operator=(FileDescriptor&&) = delete;
+
+        [[nodiscard]] int get() const noexcept {
+            return fd_;
+        }
+    };
+
+    class MappedFile {
+      private:
+        void* data_ = MAP_FAILED;   // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        std::size_t size_ = 0;
+
+      public:
+        /*
+         * Maps size bytes of fd from the given offset, which has to be a multiple of the page
+         * size, privately, i.e., writes to a mapping with PROT_WRITE are never carried through to
+         * the file.
+         */
+        MappedFile(int fd,
+                   std::size_t size,
+                   int protection = PROT_READ,
+                   int advice = MADV_SEQUENTIAL,
+                   off_t offset = 0) noexcept
+            : data_(::mmap(nullptr, size, protection, MAP_PRIVATE, fd, offset))
+            , size_(size) {
+            if (*this) {
+                ::madvise(data_, size_, advice);
+            }
+        }
+
+        ~MappedFile() {
+            if (*this) {
+                ::munmap(data_, size_);
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        explicit operator bool() const noexcept {
+            return data_ != MAP_FAILED;   // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        }
+
+        [[nodiscard]] std::string_view view() const noexcept {
+            return {static_cast<const char*>(data_), size_};
+        }
+
+        [[nodiscard]] char* data() const noexcept {
+            return static_cast<char*>(data_);
+        }
+
+        /*
+         * Releases the pages that lie entirely before the given offset.
+         */
+        void release(std::size_t offset) const noexcept {
+            const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            ::madvise(data_, offset / page_size * page_size, MADV_DONTNEED);
+        }
+    };
+
+    /*
+     * Reads fd in large blocks and calls f for each block, where each block ends on a line break.
+     * Only the last block may end with an unterminated line.
+     */
+    template <typename F> void read_blocks(int fd, F& f, std::size_t block_size) {
+        std::vector<char> buffer(block_size);
+
+        std::size_t n = 0;
+        while (true) {
+            if (n == buffer.size()) {
+                // a single line exceeds the buffer
+                buffer.resize(2 * buffer.size());
+            }
+
+            const auto n_read = ::read(fd, &buffer[n], buffer.size() - n);
+            if (n_read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+
+            if (n_read == 0) {
+                if (n > 0) {
+                    f(std::string_view(buffer.data(), n));
+                }
+                return;
+            }
+
+            n += static_cast<std::size_t>(n_read);
+
+            const auto block = std::string_view(buffer.data(), n);
+            if (auto eol = block.rfind('\n'); eol != std::string_view::npos) {
+                f(block.substr(0, eol + 1));
+
+                const auto tail = block.substr(eol + 1);
+                std::copy(tail.begin(), tail.end(), buffer.begin());
+                n = tail.size();
+            }
+        }
+    }
+}   // namespace detail
+
+constexpr std::size_t DEFAULT_BLOCK_SIZE = 1U << 22U;
+
+/*
+ * Calls f for each block of complete lines read from fd, where blocks have a size of (at least)
+ * block_size bytes. Regular files are memory mapped from the current offset of fd and blocks are
+ * passed without copying, any other input is read in chunks. Either way, fd is read to its end.
+ */
+template <typename F>
+void process_input_blocks(int fd, F&& f, std::size_t block_size = DEFAULT_BLOCK_SIZE) {
+    auto g = [&f](std::string_view block) {
+        stats::add(stats::Counter::bytes_read, block.size());
+        f(block);
+    };
+
+    // a regular file may have been read partially already, e.g., by `(head -n1; seqmaker) < file`
+    struct stat st {};
+    const auto pos = ::lseek(fd, 0, SEEK_CUR);
+    if (::fstat(fd, &st) == 0 and S_ISREG(st.st_mode) and pos >= 0   // NOLINT
+        and st.st_size > pos) {
+        const auto page_size = ::sysconf(_SC_PAGESIZE);
+        const auto offset = pos / page_size * page_size;
+        const auto skip = static_cast<std::size_t>(pos - offset);
+        const auto size = static_cast<std::size_t>(st.st_size - offset);
+        if (const detail::MappedFile file{fd, size, PROT_READ, MADV_SEQUENTIAL, offset}; file) {
+            const auto data = file.view().substr(skip);
+            for (std::size_t first = 0; first < data.size();) {
+                const auto eol = data.find('\n', first + block_size - 1);
+                const auto last = eol == std::string_view::npos ? data.size() : eol + 1;
+                g(data.substr(first, last - first));
+
+                // processed pages would otherwise count towards the resident memory
+                file.release(skip + last);
+                first = last;
+            }
+            ::lseek(fd, st.st_size, SEEK_SET);
+            return;
+        }
+    }
+
+    detail::read_blocks(fd, g, block_size);
+}
+
+/*
+ * Splits a block of lines into at most n chunks of similar size, where each chunk ends on a line
+ * break (or at the end of the block).
+ */
+[[nodiscard]] inline std::vector<std::string_view> split_block(std::string_view block, unsigned n) {
+    std::vector<std::string_view> chunks;
+    chunks.reserve(n);
+
+    const auto chunk_size = block.size() / std::max(n, 1U) + 1;
+    while (not block.empty()) {
+        auto eol = chunk_size < block.size() ? block.find('\n', chunk_size - 1)
+                                             : std::string_view::npos;
+        const auto n_chunk = eol == std::string_view::npos ? block.size() : eol + 1;
+        chunks.emplace_back(block.substr(0, n_chunk));
+        block.remove_prefix(n_chunk);
+    }
+
+    return chunks;
+}
+
+/*
+ * Expands a comma-separated list of file names and glob patterns (cf. glob(7)) to the matching
+ * files, where the matches of each pattern are sorted by name. Throws std::system_error if a
+ * pattern matches no file.
+ */
+[[nodiscard]] inline std::vector<std::string> glob(std::string_view patterns) {
+    std::vector<std::string> files;
+    for (std::size_t first = 0; first <= patterns.size();) {
+        const auto last = std::min(patterns.find(',', first), patterns.size());
+        const auto pattern = std::string{patterns.substr(first, last - first)};
+        first = last + 1;
+        if (pattern.empty()) {
+            continue;
+        }
+
+        glob_t matches{};
+        const auto status = ::glob(pattern.c_str(), 0, nullptr, &matches);
+        if (status == 0) {
+            for (std::size_t i = 0; i < matches.gl_pathc; i++) {
+                files.emplace_back(matches.gl_pathv[i]);   // NOLINT
+            }
+        }
+        ::globfree(&matches);
+
+        if (status != 0) {
+            throw std::system_error(
+                status == GLOB_NOMATCH ? ENOENT : EIO, std::generic_category(), pattern);
+        }
+    }
+
+    return files;
+}
+
+template <typename F> void process_input_lines(int fd, F&& f) {
+    process_input_blocks(fd, [&f](std::string_view block) { detail::for_each_line(block, f); });
+}
+
+template <typename F> void process_input_file(const std::filesystem::path& path, F&& f) {
+    const detail::FileDescriptor fd{path};
+    process_input_lines(fd.get(), std::forward<F>(f));
+}
+
+template <typename F> void process_input_stream(F&& f) {
+    process_input_lines(STDIN_FILENO, std::forward<F>(f));
 }
 }   // namespace seqmaker::io
@@ -2,11 +2,32 @@
 
 #include "ais.hpp"
 
+#include <cstddef>
+#include <span>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 namespace seqmaker {
+/*
+ * Counts the lines of the given files, or of standard input if there are none, per MMSI and
+ * returns the counts in descending order (and ascending order of MMSIs with a common count).
+ * Blocks of the input are split into chunks that are counted by n_threads threads, which only scan
+ * the first two columns of each line. With at least as many files as threads, each file is
+ * counted by a single thread instead.
+ */
 [[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
-    count_mmsi(std::string_view /* delimiter_ */);
+    count_mmsi(std::string_view /* delimiter_ */,
+               unsigned /* n_threads */ = 1,
+               std::span<const std::string> /* files */ = {});
+
+/*
+ * Counts the lines of a block per MMSI, cf. count_mmsi, where the second column of each line is
+ * decoded as by io::Tokenizer and lines with less than two columns throw std::invalid_argument.
+ */
+[[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
+    count_mmsi_block(std::string_view /* block */,
+                     std::string_view /* delimiter */,
+                     unsigned /* n_threads */ = 1);
 }   // namespace seqmaker
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ais.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Hash map from MMSIs to values of type T with open addressing and linear probing. Keys and values
+ * are stored in two contiguous arrays, such that probing only touches the keys. The table holds a
+ * power of two of slots and grows once it is half full. There is no erase.
+ *
+ * Slots are addressed by multiplicative (Fibonacci) hashing: valid MMSIs lie in [2e8, 8e8) and
+ * differ mostly in their lower decimal digits, which the multiplication carries into the upper
+ * bits of the product that select the slot.
+ */
+template <typename T> class MmsiMap {
+  private:
+    // marks empty slots, which is no valid MMSI
+    static constexpr ais::mmsi_t EMPTY = std::numeric_limits<ais::mmsi_t>::min();
+
+    // number of keys whose slots are prefetched ahead of their lookup by the batched find_or_insert
+    static constexpr std::size_t PREFETCH_DISTANCE = 16;
+
+    static constexpr unsigned MIN_BITS = 4;
+
+    std::vector<ais::mmsi_t> keys_;
+    std::vector<T> values_;
+    std::size_t size_ = 0;
+    unsigned bits_ = MIN_BITS;
+
+    [[nodiscard]] std::size_t slot(ais::mmsi_t mmsi) const noexcept {
+        constexpr std::uint64_t MULTIPLIER = 0x9E3779B97F4A7C15U;
+        constexpr auto N_BITS = std::numeric_limits<std::uint64_t>::digits;
+        const auto hash = std::uint64_t{static_cast<std::uint32_t>(mmsi)} * MULTIPLIER;
+        return hash >> (N_BITS - bits_);
+    }
+
+    /*
+     * The slot of the given MMSI or the empty slot where it belongs.
+     */
+    [[nodiscard]] std::size_t probe(ais::mmsi_t mmsi) const noexcept {
+        const auto mask = keys_.size() - 1;
+        auto i = slot(mmsi);
+        while (keys_[i] != mmsi and keys_[i] != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash(unsigned bits) {
+        auto keys = std::exchange(keys_, std::vector<ais::mmsi_t>(std::size_t{1} << bits, EMPTY));
+        auto values = std::exchange(values_, std::vector<T>(keys_.size()));
+        bits_ = bits;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] != EMPTY) {
+                const auto j = probe(keys[i]);
+                keys_[j] = keys[i];
+                values_[j] = std::move(values[i]);
+            }
+        }
+    }
+
+    void prefetch(ais::mmsi_t mmsi) const noexcept {
+#if defined(__GNUC__)
+        const auto i = slot(mmsi);
+        __builtin_prefetch(&keys_[i]);
+        __builtin_prefetch(&values_[i]);
+#else
+        static_cast<void>(mmsi);
+#endif
+    }
+
+  public:
+    explicit MmsiMap(std::size_t capacity = 0)
+        : keys_(std::size_t{1} << MIN_BITS, EMPTY)
+        , values_(keys_.size()) {
+        reserve(capacity);
+    }
+
+    /*
+     * Grows the table such that it holds n MMSIs without further growth.
+     */
+    void reserve(std::size_t n) {
+        const auto bits = static_cast<unsigned>(std::bit_width(2 * n));
+        if (bits > bits_) {
+            rehash(bits);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /*
+     * The value of the given MMSI, which is inserted value-initialized if it is missing, and
+     * whether it was inserted. The reference is invalidated by the next insertion.
+     */
+    std::pair<T&, bool> find_or_insert(ais::mmsi_t mmsi) {
+        assert(mmsi != EMPTY);   // NOLINT
+
+        auto i = probe(mmsi);
+        const auto inserted = keys_[i] == EMPTY;
+        if (inserted) {
+            if (2 * (size_ + 1) > keys_.size()) {
+                rehash(bits_ + 1);
+                i = probe(mmsi);
+            }
+            keys_[i] = mmsi;
+            size_++;
+        }
+        return {values_[i], inserted};
+    }
+
+    /*
+     * Calls f(x, value, inserted) for each x of the range in order, cf. find_or_insert for the
+     * MMSI key(x). The slot of each MMSI is prefetched a few elements ahead of its lookup, such
+     * that the cache misses of subsequent lookups overlap.
+     */
+    template <typename Range, typename Key, typename F>
+    void find_or_insert(Range& range, Key&& key, F&& f) {
+        const auto n = std::size(range);
+        for (std::size_t i = 0; i < std::min(n, PREFETCH_DISTANCE); i++) {
+            prefetch(key(range[i]));
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            if (i + PREFETCH_DISTANCE < n) {
+                prefetch(key(range[i + PREFETCH_DISTANCE]));
+            }
+            auto [value, inserted] = find_or_insert(key(range[i]));
+            f(range[i], value, inserted);
+        }
+    }
+
+    /*
+     * Pointer to the value of the given MMSI, if any.
+     */
+    [[nodiscard]] const T* find(ais::mmsi_t mmsi) const noexcept {
+        const auto i = probe(mmsi);
+        return keys_[i] == EMPTY ? nullptr : &values_[i];
+    }
+
+    [[nodiscard]] bool contains(ais::mmsi_t mmsi) const noexcept {
+        return find(mmsi) != nullptr;
+    }
+
+    /*
+     * Calls f(mmsi, value) for each MMSI of the map in an unspecified order.
+     */
+    template <typename F> void for_each(F&& f) const {
+        for (std::size_t i = 0; i < keys_.size(); i++) {
+            if (keys_[i] != EMPTY) {
+                f(keys_[i], values_[i]);
+            }
+        }
+    }
+};
+}   // namespace seqmaker
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ais.hpp"
+#include "binary_file.hpp"
+#include "io.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Read-only view of a pack file, which holds the sequences of all MMSIs in a single file instead
+ * of one .bin file per MMSI:
+ *
+ *  header  magic "AISPACK", format version, size of a point, number of MMSIs and points, and the
+ *          byte offsets of the following sections
+ *  index   one entry per MMSI in ascending order: the MMSI (signed 32 bit integer, followed by 4
+ *          bytes of padding), the byte offset of its points in the file and their number (both
+ *          unsigned 64 bit integers)
+ *  points  the points of all MMSIs in order of the index, each as two signed 32 bit integers
+ *          (latitude, longitude) as in the .bin files
+ *
+ * All sections are in native byte order and aligned to 64 bytes. The points of an MMSI are the
+ * concatenation of all its sequences, cf. seqmaker.
+ */
+class PackFile {
+  public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    using Sequences = std::unordered_map<ais::mmsi_t, std::vector<ais::Point>>;
+
+    struct Entry {
+        ais::mmsi_t mmsi;         // NOLINT
+        std::uint32_t padding;    // NOLINT
+        std::uint64_t offset;     // NOLINT
+        std::uint64_t n_points;   // NOLINT
+    };
+
+  private:
+    io::detail::FileDescriptor fd_;
+    io::detail::MappedFile file_;
+    std::span<const Entry> index_;
+
+  public:
+    /*
+     * Maps the given pack file. Throws std::invalid_argument if the file is no pack file of the
+     * current version or its entries are not in ascending order of MMSIs and offsets or overlap.
+     */
+    explicit PackFile(const std::filesystem::path& /* path */);
+
+    ~PackFile() = default;
+
+    PackFile(const PackFile&) = delete;
+
+    PackFile(PackFile&&) = delete;
+
+    PackFile& operator=(const PackFile&) = delete;
+
+    PackFile& operator=(PackFile&&) = delete;
+
+    /*
+     * Writes the sequences of all MMSIs to the given file, where the offsets of all MMSIs are
+     * determined upfront and the points of each MMSI are written at once.
+     */
+    static void write(const std::filesystem::path& /* path */, const Sequences& /* seqs */);
+
+    /*
+     * Number of MMSIs.
+     */
+    [[nodiscard]] std::size_t size() const noexcept {
+        return index_.size();
+    }
+
+    [[nodiscard]] ais::mmsi_t mmsi(std::size_t i) const noexcept {
+        return index_[i].mmsi;
+    }
+
+    [[nodiscard]] std::span<const ais::Point> points(std::size_t i) const noexcept {
+        const auto& entry = index_[i];
+        return {reinterpret_cast<const ais::Point*>(file_.data() + entry.offset),   // NOLINT
+                entry.n_points};
+    }
+
+    /*
+     * Points of the given MMSI, if any.
+     */
+    [[nodiscard]] std::optional<std::span<const ais::Point>> find(ais::mmsi_t /* mmsi */) const;
+
+    /*
+     * Calls f with each MMSI and its points in ascending order of MMSIs.
+     */
+    template <typename F> void for_each(F&& f) const {
+        for (std::size_t i = 0; i < size(); i++) {
+            f(mmsi(i), points(i));
+        }
+    }
+};
+}   // namespace seqmaker
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ais.hpp"
+#include "trajectory_store.hpp"
+
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Parses the first five columns of a line of AIS data. Lines with invalid data yield std::nullopt
+ * and lines with missing or empty columns throw std::invalid_argument.
+ */
+[[nodiscard]] std::optional<std::pair<ais::mmsi_t, ais::Position>>
+parse_ais_line(std::string_view /* line */, std::string_view /* delimiter */);
+
+[[nodiscard]] TrajectoryStore::Batch parse_ais_lines(std::string_view /* lines */,
+                                                     std::string_view /* delimiter */);
+
+/*
+ * Parses a block of lines using up to n_threads threads. The block is split into newline-aligned
+ * chunks that are parsed into one batch each, i.e., the concatenation of all batches is in input
+ * order.
+ */
+[[nodiscard]] std::vector<TrajectoryStore::Batch> parse_ais_block(std::string_view /* block */,
+                                                                  std::string_view /* delimiter */,
+                                                                  unsigned /* n_threads */);
+
+/*
+ * Reads and parses the lines of the given files, or of standard input if there are none, and
+ * passes the batches to f in input order, i.e., as if the files were concatenated. With at least
+ * as many files as threads, each file is read and parsed by a single thread, such that reads of
+ * several files overlap, and f is called by one thread at a time. Workers whose file is not yet
+ * passed on queue only a few blocks, i.e., memory does not scale with the size of the files.
+ * Otherwise, the files are read one after another and each block is parsed by all threads, cf.
+ * parse_ais_block.
+ */
+void parse_ais_input(std::span<const std::string> /* files */,
+                     std::string_view /* delimiter */,
+                     unsigned /* n_threads */,
+                     const std::function<void(const TrajectoryStore::Batch&)>& /* f */);
+}   // namespace seqmaker
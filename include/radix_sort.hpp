@@ -0,0 +1,77 @@
+#pragma once
+
+#include "utility.hpp"
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace seqmaker::utility {
+/*
+ * Stable least significant digit radix sort of data by the unsigned integer key(x), using n_threads
+ * threads and a scratch buffer of the same size as data. Digits that are equal for all elements
+ * are skipped.
+ */
+template <typename T, typename Alloc, typename Key>
+void radix_sort(std::vector<T, Alloc>& data, Key&& key, unsigned n_threads) {
+    using key_type = std::invoke_result_t<Key, const T&>;
+    static_assert(std::is_unsigned_v<key_type>);
+
+    constexpr unsigned RADIX_BITS = 8;
+    constexpr std::size_t N_BUCKETS = 1U << RADIX_BITS;
+    constexpr key_type MASK = N_BUCKETS - 1;
+
+    const auto n = data.size();
+    const auto n_chunks = std::max(n_threads, 1U);
+    auto chunk = [n, n_chunks](std::size_t i) {
+        return std::make_pair(i * n / n_chunks, (i + 1) * n / n_chunks);
+    };
+
+    std::vector<T, Alloc> buffer;
+    std::vector<std::array<std::size_t, N_BUCKETS>> counts(n_chunks);
+    for (unsigned shift = 0; shift < sizeof(key_type) * CHAR_BIT; shift += RADIX_BITS) {
+        auto digit = [&key, shift](const T& x) {
+            return static_cast<std::size_t>((key(x) >> shift) & MASK);
+        };
+
+        parallel_for(n_chunks, n_threads, [&](unsigned /* worker */, std::size_t i) {
+            counts[i].fill(0);
+            for (auto [first, last] = chunk(i); first < last; first++) {
+                counts[i][digit(data[first])]++;
+            }
+        });
+
+        const auto d0 = n == 0 ? std::size_t{0} : digit(data.front());
+        if (auto trivial = std::accumulate(counts.begin(),
+                                           counts.end(),
+                                           std::size_t{0},
+                                           [d0](auto acc, const auto& count) {
+                                               return acc + count[d0];
+                                           })
+                           == n;
+            trivial) {
+            continue;
+        }
+
+        // exclusive prefix sum in order of (digit, chunk) yields the first target of each chunk
+        std::size_t offset = 0;
+        for (std::size_t d = 0; d < N_BUCKETS; d++) {
+            for (auto& count : counts) {
+                offset += std::exchange(count[d], offset);
+            }
+        }
+
+        buffer.resize(n);
+        parallel_for(n_chunks, n_threads, [&](unsigned /* worker */, std::size_t i) {
+            for (auto [first, last] = chunk(i); first < last; first++) {
+                buffer[counts[i][digit(data[first])]++] = data[first];
+            }
+        });
+        data.swap(buffer);
+    }
+}
+}   // namespace seqmaker::utility
@@ -1,11 +1,46 @@
 #pragma once
 
 #include "ais.hpp"
+#include "stats.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace seqmaker {
-[[nodiscard]] std::vector<ais::Point> interpolate(const ais::Trajectory& /* trajectory */,
+/*
+ * Writes the positions of the trajectory, linearly interpolated at n_grid_points times with a
+ * spacing of dt seconds starting at the time of the first position, to out. The trajectory has
+ * to span at least (n_grid_points - 1) * dt seconds.
+ */
+template <typename OutputIt>
+OutputIt interpolate(ais::TrajectoryView trajectory,
+                     unsigned n_grid_points,
+                     unsigned dt,
+                     OutputIt out) {
+    std::size_t j = 0U;
+    const auto t0 = trajectory.front().t;
+    for (auto i = 0U; i < n_grid_points; i++) {
+        auto ti = t0 + i * dt;
+
+        while (trajectory[j + 1].t < ti) {
+            j += 1;
+        }
+
+        auto tj1 = trajectory[j].t;
+        auto tj2 = trajectory[j + 1].t;
+
+        auto w = static_cast<double>(ti - tj1) / static_cast<double>(tj2 - tj1);
+        *out++ = trajectory[j].x.interpolate(trajectory[j + 1].x, w);
+    }
+
+    return out;
+}
+
+[[nodiscard]] std::vector<ais::Point> interpolate(ais::TrajectoryView /* trajectory */,
                                                   unsigned /* n_grid_points */,
                                                   unsigned /* dt */) noexcept;
 
@@ -15,11 +50,152 @@ struct split_args {
     unsigned dti;          // NOLINT
     double ds_max;         // NOLINT
     double v_min;          // NOLINT
+
+    // metric in which distances are compared against ds_max
+    ais::Metric metric;   // NOLINT
 };
 
-[[nodiscard]] std::vector<ais::Point> split(const ais::Trajectory& /* trajectory */,
+namespace detail {
+    /*
+     * Whether the accumulated distance of an interpolated sequence corresponds to an average speed
+     * of at least v_min.
+     */
+    [[nodiscard]] bool is_fast_enough(std::span<const ais::Point> /* seq */,
+                                      const split_args& /* args */) noexcept;
+}   // namespace detail
+
+/*
+ * Incremental form of split: positions are pushed one after another in order of time and each
+ * completed sequence of (seq_length + 1) interpolated points is passed to a callback. The passed
+ * span is only valid during the call.
+ */
+class Splitter {
+  private:
+    split_args args_;
+    double ds_max_;   // in units of the metric
+    ais::Trajectory buffer_;
+    std::vector<ais::Point> seq_;
+    ais::time_t t0_ = 0;
+
+  public:
+    explicit Splitter(const split_args& args) noexcept
+        : args_(args)
+        , ds_max_(ais::from_nm(args.metric, args.ds_max)) {
+    }
+
+    void reserve(std::size_t n) {
+        buffer_.reserve(n);
+    }
+
+    /*
+     * Pushes a position, where ds is its distance to the previously pushed position (if any) in
+     * units of the metric.
+     */
+    template <typename F> void push(ais::Position pos, double ds, F&& f) {
+        buffer_.emplace_back(pos);
+
+        if (buffer_.size() == 1) {
+            t0_ = pos.t;
+        } else if (auto last_pos = buffer_[buffer_.size() - 2];
+                   pos.t - last_pos.t > args_.dt_max or ds > ds_max_) {
+            buffer_.clear();
+            buffer_.emplace_back(pos);
+            t0_ = pos.t;
+        } else if (pos.t - t0_ >= args_.seq_length * args_.dti) {
+            // (seq_length + 1) grid points for sequence length (seq_length * dti)
+            seq_.resize(args_.seq_length + 1);
+            interpolate(buffer_, args_.seq_length + 1, args_.dti, seq_.begin());
+
+            if (detail::is_fast_enough(seq_, args_)) {
+                stats::add(stats::Counter::sequences_emitted, 1);
+                f(std::span<const ais::Point>{seq_});
+            } else {
+                stats::add(stats::Counter::sequences_rejected_v_min, 1);
+            }
+            buffer_.clear();
+        }
+    }
+
+    template <typename F> void push(ais::Position pos, F&& f) {
+        const auto ds = buffer_.empty() ? 0. : ais::dist(args_.metric, pos.x, buffer_.back().x);
+        push(pos, ds, std::forward<F>(f));
+    }
+};
+
+/*
+ * Scratch buffers of split, which are reused across trajectories, e.g., one per worker thread.
+ */
+struct SplitBuffers {
+    std::vector<double> ds;
+    std::vector<ais::Point> seq;
+};
+
+/*
+ * Splits the trajectory into pieces that span seq_length * dti seconds without gaps of more than
+ * dt_max seconds or ds_max between adjacent positions, and writes the (seq_length + 1)
+ * interpolated points of each piece to out. Pieces that are slower than v_min are skipped.
+ */
+template <typename OutputIt>
+OutputIt split(ais::TrajectoryView trajectory,
+               const split_args& args,
+               SplitBuffers& buffers,
+               OutputIt out) {
+    const auto n = trajectory.size();
+    const auto n_grid_points = args.seq_length + 1;
+    const auto ds_max = ais::from_nm(args.metric, args.ds_max);
+
+    // ds[i - 1] is the distance (in units of the metric) between the positions i - 1 and i
+    auto& ds = buffers.ds;
+    ds.resize(std::max<std::size_t>(n, 1) - 1);
+    ais::adjacent_dist(args.metric, trajectory, ds);
+
+    // the current piece starts at the position first, cf. Splitter
+    std::size_t first = 0;
+    std::uint64_t n_emitted = 0;
+    std::uint64_t n_rejected = 0;
+    for (std::size_t i = 1; i < n; i++) {
+        if (i == first) {
+            continue;
+        }
+
+        if (trajectory[i].t - trajectory[i - 1].t > args.dt_max or ds[i - 1] > ds_max) {
+            first = i;
+        } else if (trajectory[i].t - trajectory[first].t >= args.seq_length * args.dti) {
+            const auto piece = trajectory.subspan(first, i - first + 1);
+            if (args.v_min > 0.) {
+                auto& seq = buffers.seq;
+                seq.resize(n_grid_points);
+                interpolate(piece, n_grid_points, args.dti, seq.begin());
+                if (detail::is_fast_enough(seq, args)) {
+                    out = std::copy(seq.begin(), seq.end(), out);
+                    n_emitted++;
+                } else {
+                    n_rejected++;
+                }
+            } else {
+                out = interpolate(piece, n_grid_points, args.dti, out);
+                n_emitted++;
+            }
+            first = i + 1;
+        }
+    }
+
+    stats::add(stats::Counter::sequences_emitted, n_emitted);
+    stats::add(stats::Counter::sequences_rejected_v_min, n_rejected);
+    return out;
+}
+
+[[nodiscard]] std::vector<ais::Point> split(ais::TrajectoryView /* trajectory */,
                                             const split_args& /* args */) noexcept;
 
-[[nodiscard]] double drop_rate(const ais::Trajectory& /* trajectory */,
+/*
+ * Fraction of the positions of the trajectory that are not part of any sequence, where the
+ * distances of adjacent positions are computed into buffers.ds.
+ */
+[[nodiscard]] double drop_rate(ais::TrajectoryView /* trajectory */,
+                               const split_args& /* split_args */,
+                               SplitBuffers& /* buffers */) noexcept;
+
+[[nodiscard]] double drop_rate(ais::TrajectoryView /* trajectory */,
                                split_args /* split_args */) noexcept;
 }   // namespace seqmaker
@@ -1,15 +1,18 @@
 #pragma once
 
 #include "ais.hpp"
+#include "seq.hpp"
 #include "sequencer.hpp"
 
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace seqmaker {
 class SequenceCounter final: public Sequencer {
   private:
-    std::unordered_map<ais::mmsi_t, double> drop_rates_;
+    std::vector<std::unordered_map<ais::mmsi_t, double>> drop_rates_;   // per worker
+    std::vector<SplitBuffers> buffers_;                                 // per worker
 
   public:
     template <typename... Ts>
@@ -26,12 +29,16 @@ class SequenceCounter final: public Sequencer {
 
     SequenceCounter& operator=(SequenceCounter&&) = default;
 
-    void init(std::size_t /* n_trajectories */) noexcept override {
+    void init(std::size_t /* n_trajectories */, unsigned n_workers) noexcept override {
+        drop_rates_.resize(n_workers);
+        buffers_.resize(n_workers);
     }
 
-    void process(ais::mmsi_t /* mmsi */, const ais::Trajectory& /* trajectory */) noexcept override;
+    void process(unsigned /* worker */,
+                 ais::mmsi_t /* mmsi */,
+                 ais::TrajectoryView /* trajectory */) noexcept override;
 
     [[nodiscard]] std::unordered_map<ais::mmsi_t, double>
-    run(bool /* apply_low_pass_filter */) noexcept;
+    run(bool /* apply_low_pass_filter */);
 };
 }   // namespace seqmaker
@@ -1,39 +1,126 @@
 #pragma once
 
 #include "ais.hpp"
+#include "histogram.hpp"
 #include "sequencer.hpp"
 
-#include <string_view>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace seqmaker {
 class SequenceDiff final: public Sequencer {
+  public:
+    using Diff = std::pair<ais::time_t, ais::Point::value_type>;
+    using Sink = std::function<void(std::size_t /* k */, std::span<const Diff>)>;
+
   private:
-    unsigned stride_{};
-    std::vector<std::pair<ais::time_t, ais::Point::value_type>> diffs_;
+    // differences that are passed to a sink at once
+    static constexpr std::size_t SINK_CHUNK_SIZE = 1U << 16U;
+
+    // differences of finished trajectories that may wait for a trajectory with a lower MMSI
+    static constexpr std::size_t MAX_PENDING = 1U << 22U;
+
+    struct Worker {
+        std::vector<double> dx;
+        std::vector<std::vector<Diff>> diffs;   // per stride, of the current trajectory
+        std::vector<Histogram2D> hists;         // per stride
+    };
+
+    std::vector<unsigned> strides_;
+    std::vector<Worker> workers_;
+    Sink sink_;
+    std::optional<Histogram2D> hist_;   // binning of histogram mode
+
+    struct Handoff {
+        std::mutex mutex;
+        std::condition_variable handed_off;   // signalled whenever next_ advances
+    };
+
+    // handoff of the differences of each trajectory in the order they are handed out, cf. complete
+    std::unique_ptr<Handoff> handoff_ = std::make_unique<Handoff>();
+    std::vector<std::vector<Diff>> chunks_;   // per stride, not yet passed to the sink
+    std::unordered_map<std::size_t, std::vector<std::vector<Diff>>> pending_;
+    std::vector<bool> done_;                  // per trajectory of the round
+    std::size_t next_ = 0;                    // first trajectory that is not handed off
+    std::size_t n_pending_ = 0;
+
+    /*
+     * Appends the differences of a trajectory to the chunks and passes full chunks to the sink.
+     */
+    void hand_off(const std::vector<std::vector<Diff>>& /* diffs */);
+
+    /*
+     * Passes the remaining chunks to the sink.
+     */
+    void flush();
 
   public:
-    explicit SequenceDiff(std::string_view delimiter)
-        : Sequencer(split_args{.seq_length = 0, .dt_max = 1, .dti = 0, .ds_max = 0., .v_min = 0.},
-                    delimiter) {
+    explicit SequenceDiff(input_args input_args,
+                          ais::Metric metric = ais::Metric::equirectangular)
+        : Sequencer(split_args{.seq_length = 0,
+                               .dt_max = 1,
+                               .dti = 0,
+                               .ds_max = 0.,
+                               .v_min = 0.,
+                               .metric = metric},
+                    input_args) {
     }
 
     ~SequenceDiff() override = default;
 
-    SequenceDiff(const SequenceDiff&) = default;
+    SequenceDiff(const SequenceDiff&) = delete;
 
     SequenceDiff(SequenceDiff&&) = default;
 
-    SequenceDiff& operator=(const SequenceDiff&) = default;
+    SequenceDiff& operator=(const SequenceDiff&) = delete;
 
     SequenceDiff& operator=(SequenceDiff&&) = default;
 
-    void init(std::size_t /* n_trajectories */) noexcept override {
-    }
+    void init(std::size_t /* n_trajectories */, unsigned n_workers) noexcept override;
+
+    void process(unsigned /* worker */,
+                 ais::mmsi_t /* mmsi */,
+                 ais::TrajectoryView /* trajectory */) noexcept override;
+
+    /*
+     * Hands off the differences of the i-th trajectory as soon as those of all trajectories with a
+     * lower MMSI are handed off. Otherwise, they are kept until then, where the worker waits while
+     * more than MAX_PENDING differences are kept. The worker of the first trajectory that is not
+     * handed off never waits, hence the workers cannot block each other.
+     */
+    void complete(unsigned /* worker */, std::size_t /* i */) noexcept override;
+
+    /*
+     * Differences of all trajectories in ascending order of MMSIs, cf. the sink overload.
+     */
+    std::vector<Diff> run(unsigned /* stride */);
 
-    void process(ais::mmsi_t /* mmsi */, const ais::Trajectory& /* trajectory */) noexcept override;
+    /*
+     * Passes the differences of each of the given strides in chunks to the sink, where k is the
+     * index of the stride. All strides of a trajectory are processed at once. Trajectories are
+     * handed out in ascending order of MMSIs within each round (cf. Sequencer::init) and their
+     * differences are passed on in this order while further trajectories are processed, i.e., the
+     * output does not depend on the number of threads. This comes at the cost of handing out long
+     * trajectories first. The sink is called by one thread at a time and the passed span is only
+     * valid during the call.
+     */
+    void run(std::vector<unsigned> /* strides */, Sink /* sink */);
 
-    std::vector<std::pair<ais::time_t, ais::Point::value_type>> run(unsigned /* stride */) noexcept;
+    /*
+     * Fills the differences of time (x) and position (y) of each of the given strides into a
+     * histogram with the binning of the given one instead of gathering them. Each worker fills
+     * its own histograms, which are merged at the end, i.e., memory does not scale with the
+     * number of differences.
+     */
+    [[nodiscard]] std::vector<Histogram2D> run(std::vector<unsigned> /* strides */,
+                                               const Histogram2D& /* hist */);
 };
 }   // namespace seqmaker
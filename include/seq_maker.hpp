@@ -1,16 +1,25 @@
 #pragma once
 
 #include "ais.hpp"
+#include "seq.hpp"
 #include "sequencer.hpp"
 
+#include <functional>
+#include <span>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace seqmaker {
 class SequenceMaker final: public Sequencer {
+  public:
+    using Sink = std::function<void(ais::mmsi_t, std::span<const ais::Point>)>;
+
   private:
-    std::unordered_map<ais::mmsi_t, std::vector<ais::Point>> seqs_;
+    std::vector<std::unordered_map<ais::mmsi_t, std::vector<ais::Point>>> seqs_;   // per worker
+    std::vector<SplitBuffers> buffers_;                                            // per worker
+    std::vector<std::vector<ais::Point>> stripped_seqs_;                           // per worker
+    Sink sink_;
 
   public:
     template <typename... Ts>
@@ -27,11 +36,19 @@ class SequenceMaker final: public Sequencer {
 
     SequenceMaker& operator=(SequenceMaker&&) = default;
 
-    void init(std::size_t /* n_trajectories */) noexcept override;
+    void init(std::size_t /* n_trajectories */, unsigned /* n_workers */) noexcept override;
+
+    void process(unsigned /* worker */,
+                 ais::mmsi_t /* mmsi */,
+                 ais::TrajectoryView /* trajectory */) noexcept override;
 
-    void process(ais::mmsi_t /* mmsi */, const ais::Trajectory& /* trajectory */) noexcept override;
+    std::unordered_map<ais::mmsi_t, std::vector<ais::Point>> run(bool /* apply_low_pass_filter */);
 
-    std::unordered_map<ais::mmsi_t, std::vector<ais::Point>>
-    run(bool /* apply_low_pass_filter */) noexcept;
+    /*
+     * Passes the sequences of each MMSI to the sink as soon as they are complete instead of
+     * gathering them, where the sink is called concurrently by all workers. The passed span is
+     * only valid during the call.
+     */
+    void run(bool /* apply_low_pass_filter */, Sink /* sink */);
 };
 }   // namespace seqmaker
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ais.hpp"
+#include "seq.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace seqmaker {
+struct stream_args {
+    unsigned reorder_window = 0;          // NOLINT
+    bool apply_low_pass_filter = false;   // NOLINT
+};
+
+/*
+ * Splits a stream of positions into sequences without gathering whole trajectories first. Positions
+ * are expected to arrive roughly in order of time: each vessel keeps its positions of the last
+ * reorder_window seconds (relative to the latest time seen in the stream) in a reorder buffer,
+ * from which they are passed on in order of time, the first of several positions with a common
+ * time only. Positions that are older than the last passed position of their vessel are dropped.
+ *
+ * Each completed sequence is passed to the sink as soon as it spans seq_length * dti seconds and
+ * the state of a vessel is evicted once the stream has advanced by more than dt_max seconds beyond
+ * its latest position. Memory thus scales with the number of active vessels.
+ *
+ * For a stream ordered by time, the same sequences are emitted as by SequenceMaker, except for the
+ * low pass filter which does not look past gaps of more than dt_max seconds.
+ */
+class SequenceStreamer final {
+  public:
+    using Sink = std::function<void(ais::mmsi_t, std::span<const ais::Point>)>;
+
+  private:
+    struct Vessel {
+        std::vector<ais::Position> pending;   // reorder buffer, ordered by time
+        ais::time_t t_max = 0;                // latest time received
+        ais::Position last{};                 // last position passed on
+        bool has_last = false;
+        bool last_valid = false;   // last position is within ds_max of its predecessor
+        Splitter splitter;
+
+        explicit Vessel(const split_args& args) noexcept : splitter(args) {
+        }
+    };
+
+    split_args split_args_;
+    stream_args stream_args_;
+    Sink sink_;
+    std::unordered_map<ais::mmsi_t, Vessel> vessels_;
+    ais::time_t t_max_ = 0;
+    ais::time_t next_eviction_ = 0;
+    std::size_t n_dropped_ = 0;
+
+    [[nodiscard]] ais::time_t watermark() const noexcept;
+
+    void feed(ais::mmsi_t /* mmsi */, Vessel& /* vessel */, ais::Position /* pos */);
+
+    void release(ais::mmsi_t /* mmsi */, Vessel& /* vessel */, ais::time_t /* watermark */);
+
+    void close(ais::mmsi_t /* mmsi */, Vessel& /* vessel */);
+
+    void evict();
+
+  public:
+    SequenceStreamer(split_args /* split_args */, stream_args /* stream_args */, Sink /* sink */);
+
+    void push(ais::mmsi_t /* mmsi */, ais::Position /* pos */);
+
+    /*
+     * Passes on all buffered positions and drops the state of all vessels.
+     */
+    void finish();
+
+    /*
+     * Reads lines of AIS data from the given files or standard input (cf. parse_ais_input) until
+     * the end of the input and calls finish. Files are read in the given order, i.e., the reorder
+     * window applies to their concatenation.
+     */
+    void run(std::string_view /* delimiter */,
+             unsigned /* n_threads */,
+             std::span<const std::string> /* files */ = {});
+
+    /*
+     * Number of positions dropped for arriving later than the reorder window allows.
+     */
+    [[nodiscard]] std::size_t n_dropped() const noexcept {
+        return n_dropped_;
+    }
+
+    /*
+     * Number of vessels with state, i.e., positions within the last dt_max seconds of the stream.
+     */
+    [[nodiscard]] std::size_t n_active() const noexcept {
+        return vessels_.size();
+    }
+};
+}   // namespace seqmaker
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ais.hpp"
+#include "seq.hpp"
+#include "sequencer.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Expands a grid of split arguments, given as options with comma-separated values, e.g.,
+ * "-N 360,720 -s .1,.5", into all combinations thereof. The options -N, -t, -s, -i and -v set
+ * seq_length, dt_max, ds_max, dti and v_min, respectively, and omitted options keep the value of
+ * defaults. Throws std::invalid_argument for unknown options or invalid values.
+ */
+[[nodiscard]] std::vector<split_args> expand_grid(std::string_view /* grid */,
+                                                  const split_args& /* defaults */);
+
+/*
+ * Splits all trajectories for each of several configurations of split arguments, where the input
+ * is read, grouped and ordered once and the configurations are evaluated one after another on
+ * each trajectory while it is hot in the cache. The results of each configuration are the same as
+ * those of SequenceMaker and SequenceCounter with the respective arguments.
+ */
+class SequenceSweep final: public Sequencer {
+  public:
+    using Sink = std::function<void(std::size_t, ais::mmsi_t, std::span<const ais::Point>)>;
+
+    struct Result {
+        // empty if only counted or passed to a sink
+        std::unordered_map<ais::mmsi_t, std::vector<ais::Point>> seqs;
+        std::unordered_map<ais::mmsi_t, double> drop_rates;
+        std::size_t n_sequences = 0;
+
+        // sum of the drop rates weighted by the number of positions of the respective trajectory
+        double n_dropped = 0.;
+        std::size_t n_positions = 0;
+
+        /*
+         * Drop rate of all trajectories with a drop rate, weighted by their number of positions.
+         */
+        [[nodiscard]] double drop_rate() const noexcept {
+            return n_positions > 0 ? n_dropped / static_cast<double>(n_positions) : 1.;
+        }
+    };
+
+  private:
+    struct Worker {
+        std::vector<Result> results;   // per configuration
+        SplitBuffers buffers;
+        ais::Trajectory filtered;
+        std::vector<ais::Point> seqs;
+    };
+
+    std::vector<split_args> configs_;
+    std::vector<Worker> workers_;
+    bool apply_low_pass_filter_ = false;
+    bool count_only_ = false;
+    Sink sink_;
+
+  public:
+    SequenceSweep(std::vector<split_args> /* configs */, input_args /* input_args */);
+
+    ~SequenceSweep() override = default;
+
+    SequenceSweep(const SequenceSweep&) = default;
+
+    SequenceSweep(SequenceSweep&&) = default;
+
+    SequenceSweep& operator=(const SequenceSweep&) = default;
+
+    SequenceSweep& operator=(SequenceSweep&&) = default;
+
+    void init(std::size_t /* n_trajectories */, unsigned /* n_workers */) noexcept override;
+
+    void process(unsigned /* worker */,
+                 ais::mmsi_t /* mmsi */,
+                 ais::TrajectoryView /* trajectory */) noexcept override;
+
+    /*
+     * Returns the results of all configurations in the order they were passed. If count_only is
+     * set, sequences are counted but not kept.
+     */
+    [[nodiscard]] std::vector<Result> run(bool /* apply_low_pass_filter */,
+                                          bool /* count_only */);
+
+    /*
+     * Passes the sequences of each MMSI and configuration, given by its index, to the sink as soon
+     * as they are complete instead of keeping them until all configurations are done, where the
+     * sink is called concurrently by all workers. The passed span is only valid during the call.
+     */
+    [[nodiscard]] std::vector<Result> run(bool /* apply_low_pass_filter */, Sink /* sink */);
+};
+}   // namespace seqmaker
@@ -2,23 +2,88 @@
 
 #include "ais.hpp"
 #include "seq.hpp"
+#include "spill.hpp"
+#include "trajectory_cache.hpp"
+#include "trajectory_store.hpp"
 
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
 #include <string_view>
-#include <unordered_map>
 
 namespace seqmaker {
+struct input_args {
+    std::string_view delimiter;   // NOLINT
+    unsigned n_threads = 1;       // NOLINT
+    bool radix_sort = false;      // NOLINT
+
+    // budget in bytes for staged positions, beyond which positions are spilled to disk (0: none)
+    std::size_t mem_limit = 0;   // NOLINT
+
+    // trajectory cache that is mapped instead of reading standard input (empty: none)
+    std::string_view cache{};   // NOLINT
+
+    // files that are read instead of standard input (empty: none), cf. parse_ais_input
+    std::span<const std::string> files{};   // NOLINT
+};
+
 class Sequencer {
   private:
-    std::unordered_map<ais::mmsi_t, ais::Trajectory> trajectories_{};
+    TrajectoryStore trajectories_{};
+    input_args input_args_;
+    std::shared_ptr<SpillFiles> spill_;
+    std::shared_ptr<TrajectoryCache> cache_;
+
+    void stage(const TrajectoryStore::Batch& /* batch */);
+
+    void run_trajectories(bool /* apply_low_pass_filter */);
+
+    template <typename Store>
+    void run_trajectories(Store& /* trajectories */, bool /* apply_low_pass_filter */);
+
+    void run_trajectory(unsigned /* worker */,
+                        ais::mmsi_t /* mmsi */,
+                        std::span<ais::Position> /* trajectory */,
+                        bool /* is_sorted */,
+                        bool /* apply_low_pass_filter */) noexcept;
 
   protected:
     std::string_view delimiter_;   // NOLINT
     split_args split_args_;        // NOLINT
 
-    void run(bool /* apply_low_pass_filter */) noexcept;
+    // whether trajectories are handed out in ascending order of MMSIs instead of the longest first
+    bool in_mmsi_order_ = false;   // NOLINT
+
+    /*
+     * Processes all trajectories. If positions were spilled to disk, the partitions are loaded and
+     * processed one after another, where as many partitions are loaded at once as fit into the
+     * memory budget. Trajectories of a cache are processed in place.
+     */
+    void run(bool /* apply_low_pass_filter */);
+
+    /*
+     * Applies the low pass filter (cf. utility::low_pass_filter) with the spatial threshold of
+     * args to a trajectory that is ordered by time. The passed positions are moved to the front
+     * and their number is returned.
+     */
+    [[nodiscard]] static std::size_t low_pass_filter(std::span<ais::Position> /* trajectory */,
+                                                     const split_args& /* args */) noexcept;
+
+    /*
+     * Whether a trajectory that is ordered by time is long enough to yield a sequence.
+     */
+    [[nodiscard]] static bool spans_sequence(ais::TrajectoryView /* trajectory */,
+                                             const split_args& /* args */) noexcept;
 
   public:
-    explicit Sequencer(split_args /* split_args */, std::string_view /* delimiter */ = "");
+    Sequencer(split_args /* split_args */, input_args /* input_args */);
+
+    explicit Sequencer(split_args split_args,
+                       std::string_view delimiter = "",
+                       unsigned n_threads = 1)
+        : Sequencer(split_args, input_args{.delimiter = delimiter, .n_threads = n_threads}) {
+    }
 
     virtual ~Sequencer() = default;
 
@@ -30,11 +95,27 @@ class Sequencer {
 
     Sequencer& operator=(Sequencer&&) = default;
 
-    virtual void init(std::size_t /* n_trajectories */) noexcept = 0;
+    /*
+     * Called before each round of calls of process, where process is called concurrently by up to
+     * n_workers threads and each thread passes its own worker index in [0, n_workers). There is
+     * one round per loaded set of partitions (cf. run) and n_workers is the same in each round.
+     */
+    virtual void init(std::size_t /* n_trajectories */, unsigned /* n_workers */) noexcept = 0;
+
+    virtual void process(unsigned /* worker */,
+                         ais::mmsi_t /* mmsi */,
+                         ais::TrajectoryView /* trajectory */) noexcept = 0;
 
-    virtual void process(ais::mmsi_t /* mmsi */,
-                         const ais::Trajectory& /* trajectory */) noexcept = 0;
+    /*
+     * Called by a worker once it is done with the i-th trajectory of a round in the order they are
+     * handed out, i.e., after process if the trajectory was passed to it at all.
+     */
+    virtual void complete(unsigned /* worker */, std::size_t /* i */) noexcept {
+    }
 
-    void add_trajectory(ais::mmsi_t /* mmsi */, const ais::Trajectory& /* trajectory */) noexcept;
+    /*
+     * Adds the positions of the given trajectory to the trajectory of the given MMSI.
+     */
+    void add_trajectory(ais::mmsi_t /* mmsi */, ais::TrajectoryView /* trajectory */);
 };
 }   // namespace seqmaker
\ No newline at end of file
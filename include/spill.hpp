@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ais.hpp"
+#include "trajectory_store.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Partitions positions by a hash of their MMSI into temporary files, such that all positions of a
+ * trajectory end up in the same partition and keep the order in which they were appended. Each
+ * position is stored as four 32 bit integers (MMSI, time, latitude, longitude) in native byte
+ * order. The files are removed together with their directory on destruction.
+ */
+class SpillFiles {
+  public:
+    static constexpr std::size_t RECORD_SIZE = 4 * sizeof(std::int32_t);
+
+  private:
+    // records that are buffered per partition before being written, 64 KiB per partition
+    static constexpr std::size_t BUFFER_SIZE = 1U << 12U;
+
+    std::filesystem::path dir_;
+    std::vector<std::ofstream> files_;
+    std::vector<std::vector<char>> buffers_;
+    std::vector<std::size_t> sizes_;
+
+    [[nodiscard]] std::filesystem::path path(std::size_t /* partition */) const;
+
+    void write(std::size_t /* partition */);
+
+  public:
+    /*
+     * Creates n_partitions empty files in a new directory below the temporary directory of the
+     * system, i.e., $TMPDIR or /tmp.
+     */
+    explicit SpillFiles(std::size_t /* n_partitions */);
+
+    ~SpillFiles();
+
+    SpillFiles(const SpillFiles&) = delete;
+
+    SpillFiles(SpillFiles&&) = delete;
+
+    SpillFiles& operator=(const SpillFiles&) = delete;
+
+    SpillFiles& operator=(SpillFiles&&) = delete;
+
+    [[nodiscard]] std::size_t n_partitions() const noexcept {
+        return sizes_.size();
+    }
+
+    /*
+     * Number of positions in the given partition.
+     */
+    [[nodiscard]] std::size_t size(std::size_t partition) const noexcept {
+        return sizes_[partition];
+    }
+
+    [[nodiscard]] std::size_t partition(ais::mmsi_t /* mmsi */) const noexcept;
+
+    void append(const TrajectoryStore::Batch& /* batch */);
+
+    /*
+     * Writes all buffered positions. Has to be called before partitions are loaded.
+     */
+    void flush();
+
+    /*
+     * Appends all positions of the given partition to the store in the order they were spilled.
+     */
+    void load(std::size_t /* partition */, TrajectoryStore& /* store */) const;
+};
+}   // namespace seqmaker
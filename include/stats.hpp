@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace seqmaker::stats {
+/*
+ * Counters of the pipeline, where rows are rejected for the first of the listed reasons that
+ * applies. Columns are separated by runs of delimiters, i.e., an empty column is a missing one.
+ * Positions are dropped by the reorder window of a SequenceStreamer, which does not count
+ * trajectories. In a sweep, filtered points and sequences add up over all configurations.
+ */
+enum class Counter : std::size_t {
+    bytes_read,
+    rows_parsed,
+    rows_rejected_missing_column,
+    rows_rejected_time,
+    rows_rejected_mmsi,
+    rows_rejected_slot,
+    rows_rejected_position,
+    duplicates_removed,
+    points_filtered,
+    positions_dropped,
+    trajectories_processed,
+    trajectories_skipped,
+    sequences_emitted,
+    sequences_rejected_v_min,
+    bytes_written,
+    n_counters
+};
+
+/*
+ * Stages of the pipeline, whose times are inclusive, i.e., a stage contains the times of the stages
+ * nested in it: input contains parse (and process for a SequenceStreamer, which splits sequences
+ * while reading), and process contains split and dump. The times of group and write are disjoint
+ * from the other stages, as are the ones of dump in a sweep, which writes after processing.
+ *
+ * Stages that run concurrently on several threads, i.e., split, dump, and parse when several files
+ * are read in parallel, add up the times of all their calls, where the CPU time is the one of the
+ * calling thread (cf. Clock). The CPU time of the other stages is the one of the whole process,
+ * except for process of a SequenceStreamer.
+ */
+enum class Stage : std::size_t { input, parse, group, process, split, dump, write, n_stages };
+
+/*
+ * CPU clock of a Scope: the one of the whole process, or the one of the calling thread for scopes
+ * that run concurrently.
+ */
+enum class Clock { process, thread };
+
+[[nodiscard]] std::string_view to_string(Counter /* counter */) noexcept;
+
+[[nodiscard]] std::string_view to_string(Stage /* stage */) noexcept;
+
+namespace detail {
+    // set before any thread is started, cf. enable and disable
+    inline bool enabled = false;   // NOLINT
+
+    inline std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::n_counters)>
+        counters{};   // NOLINT
+
+    struct Times {
+        std::atomic<std::uint64_t> wall_ns{0};
+        std::atomic<std::uint64_t> cpu_ns{0};
+        std::atomic<std::uint64_t> calls{0};
+    };
+
+    inline std::array<Times, static_cast<std::size_t>(Stage::n_stages)> times{};   // NOLINT
+}   // namespace detail
+
+/*
+ * Enables the recording of statistics, which has to be called before any statistics are recorded,
+ * i.e., before threads are started. Otherwise, recording is a no-op apart from a branch.
+ */
+void enable() noexcept;
+
+/*
+ * Disables the recording, which must not race with threads that record statistics.
+ */
+void disable() noexcept;
+
+[[nodiscard]] inline bool enabled() noexcept {
+    return detail::enabled;
+}
+
+inline void add(Counter counter, std::uint64_t n) noexcept {
+    if (enabled()) {
+        detail::counters[static_cast<std::size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+[[nodiscard]] std::uint64_t get(Counter /* counter */) noexcept;
+
+/*
+ * Resets all counters and times, but does not disable the recording.
+ */
+void reset() noexcept;
+
+/*
+ * Adds the wall and CPU time between construction and destruction to the given stage.
+ */
+class Scope {
+  private:
+    Stage stage_;
+    Clock clock_;
+    bool active_;
+    std::uint64_t wall_ns_ = 0;
+    std::uint64_t cpu_ns_ = 0;
+
+  public:
+    explicit Scope(Stage /* stage */, Clock /* clock */ = Clock::process) noexcept;
+
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+
+    Scope(Scope&&) = delete;
+
+    Scope& operator=(const Scope&) = delete;
+
+    Scope& operator=(Scope&&) = delete;
+};
+
+/*
+ * Writes the times of all stages, all counters, and the peak resident set size of the process as
+ * JSON to the given file.
+ */
+void write_json(const std::filesystem::path& /* path */);
+}   // namespace seqmaker::stats
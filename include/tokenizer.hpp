@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace seqmaker::io {
+/*
+ * Splits blocks of lines into columns, where each character of the delimiter separates columns
+ * and empty columns are skipped, cf. utility::split_map. The block is classified 64 bytes at a
+ * time into bitmasks of delimiters and newlines, from which the column offsets of all lines are
+ * extracted without a scan per column. A trailing carriage return of a line is ignored.
+ */
+class Tokenizer {
+  private:
+    // lines are tokenized in sub-blocks of at least this size to bound the memory of the tokens
+    static constexpr std::size_t SUB_BLOCK_SIZE = 1U << 16U;
+
+    std::string delimiter_;
+    std::array<bool, 256> is_delimiter_{};   // NOLINT
+
+  public:
+    explicit Tokenizer(std::string_view /* delimiter */) noexcept;
+
+    /*
+     * Appends the first n_columns columns of each line of the block to tokens and returns the
+     * number of lines. Throws std::invalid_argument if a line has less than n_columns columns.
+     */
+    std::size_t tokenize(std::string_view /* block */,
+                         std::size_t /* n_columns */,
+                         std::vector<std::string_view>& /* tokens */) const;
+
+    /*
+     * Tokenizes the block in batches of lines and calls f with the first n_columns columns of all
+     * lines of each batch, i.e., a span of (n_lines * n_columns) columns ordered by line.
+     */
+    template <typename F>
+    void for_each_batch(std::string_view block, std::size_t n_columns, F&& f) const {
+        std::vector<std::string_view> tokens;
+        for (std::size_t first = 0; first < block.size();) {
+            const auto eol = block.find('\n', first + SUB_BLOCK_SIZE - 1);
+            const auto last = eol == std::string_view::npos ? block.size() : eol + 1;
+
+            tokens.clear();
+            tokenize(block.substr(first, last - first), n_columns, tokens);
+            f(std::span<const std::string_view>{tokens});
+            first = last;
+        }
+    }
+
+    /*
+     * Calls f with the first N columns of each line of the block.
+     */
+    template <std::size_t N, typename F> void for_each_row(std::string_view block, F&& f) const {
+        for_each_batch(block, N, [&f](std::span<const std::string_view> tokens) {
+            for (std::size_t i = 0; i < tokens.size(); i += N) {
+                [&f, row = tokens.subspan(i, N)]<std::size_t... I>(std::index_sequence<I...>) {
+                    f(row[I]...);
+                }(std::make_index_sequence<N>{});
+            }
+        });
+    }
+};
+}   // namespace seqmaker::io
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ais.hpp"
+#include "binary_file.hpp"
+#include "io.hpp"
+#include "trajectory_store.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace seqmaker {
+/*
+ * Read-only view of a cache file of validated, slot-corrected positions, which are grouped and
+ * ordered by (MMSI, time) as by TrajectoryStore::sort. The file mirrors the columns of the store:
+ *
+ *  header     magic "AISCACHE", format version, size of a position record, number of
+ *             trajectories and positions, and byte offsets of the following columns
+ *  MMSIs      one signed 32 bit integer per trajectory, in ascending order
+ *  offsets    one unsigned 64 bit integer per trajectory and a trailing one, i.e., trajectory i
+ *             spans the positions [offsets[i], offsets[i + 1])
+ *  positions  one record per position (time, latitude, longitude) as in memory
+ *
+ * All columns are in native byte order and aligned to 64 bytes. The file is memory mapped and
+ * trajectories are views into the mapping without copies. The mapping is private, i.e., in-place
+ * modifications of trajectories (e.g., by a low pass filter) copy the affected pages only and are
+ * never written back to the file.
+ */
+class TrajectoryCache {
+  public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    /*
+     * Writes a cache file whose trajectories are known in advance by their MMSIs and offsets (cf.
+     * above), while their positions are appended piecewise in order, i.e., the positions need
+     * not be held in memory at once.
+     */
+    class Writer {
+      private:
+        io::BinaryWriter out_;
+        std::uint64_t size_;   // bytes of the complete file
+
+      public:
+        /*
+         * Throws std::invalid_argument if the MMSIs are not ascending or the offsets do not start
+         * at 0 or are not ascending.
+         */
+        Writer(std::filesystem::path /* path */,
+               std::span<const ais::mmsi_t> /* mmsis */,
+               std::span<const std::uint64_t> /* offsets */);
+
+        /*
+         * Appends positions of the current trajectory, which have to be ordered by time.
+         */
+        void append(ais::TrajectoryView /* positions */);
+
+        /*
+         * Flushes the file. Throws std::invalid_argument if not all positions were appended.
+         */
+        void close();
+    };
+
+  private:
+    io::detail::FileDescriptor fd_;
+    io::detail::MappedFile file_;
+    std::span<const ais::mmsi_t> mmsis_;
+    std::span<const std::uint64_t> offsets_;
+    std::span<ais::Position> positions_;
+
+  public:
+    /*
+     * Maps the given cache file. Throws std::invalid_argument if the file is no cache file of the
+     * current version or its MMSIs or offsets are not ascending.
+     */
+    explicit TrajectoryCache(const std::filesystem::path& /* path */);
+
+    ~TrajectoryCache() = default;
+
+    TrajectoryCache(const TrajectoryCache&) = delete;
+
+    TrajectoryCache(TrajectoryCache&&) = delete;
+
+    TrajectoryCache& operator=(const TrajectoryCache&) = delete;
+
+    TrajectoryCache& operator=(TrajectoryCache&&) = delete;
+
+    /*
+     * Writes the trajectories of a sorted store (cf. TrajectoryStore::sort) to the given file.
+     */
+    static void write(const std::filesystem::path& /* path */, const TrajectoryStore& /* store */);
+
+    /*
+     * Reads lines of AIS data from the given files or standard input (cf. parse_ais_input), sorts
+     * them by (MMSI, time) and writes them to the given file.
+     */
+    static void build(const std::filesystem::path& /* path */,
+                      std::string_view /* delimiter */,
+                      unsigned /* n_threads */,
+                      std::span<const std::string> /* files */ = {});
+
+    [[nodiscard]] static constexpr bool is_sorted() noexcept {
+        return true;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return mmsis_.size();
+    }
+
+    [[nodiscard]] std::size_t n_positions() const noexcept {
+        return positions_.size();
+    }
+
+    [[nodiscard]] ais::mmsi_t mmsi(std::size_t i) const noexcept {
+        return mmsis_[i];
+    }
+
+    /*
+     * Index of the trajectory of the given MMSI, if any.
+     */
+    [[nodiscard]] std::optional<std::size_t> find(ais::mmsi_t /* mmsi */) const noexcept;
+
+    [[nodiscard]] std::span<ais::Position> trajectory(std::size_t i) noexcept {
+        return positions_.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    [[nodiscard]] ais::TrajectoryView trajectory(std::size_t i) const noexcept {
+        return positions_.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+};
+}   // namespace seqmaker
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ais.hpp"
+#include "utility.hpp"
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace seqmaker {
+/*
+ * Stores the positions of all trajectories in a single contiguous column, grouped by MMSI, and an
+ * index of (MMSI, offset) pairs. Positions are staged in arbitrary order of MMSIs and grouped by a
+ * call of group(), which keeps the order of positions within each trajectory.
+ *
+ * Alternatively, sort() groups staged positions with a radix sort by (MMSI, time) and additionally
+ * orders each trajectory by time and removes positions with duplicate times.
+ *
+ * Staged positions are kept in fixed-size chunks that are released one by one while grouping.
+ * Since each trajectory is filled from front to back, the memory of the grouped column becomes
+ * resident at the same rate as the staged chunks are released.
+ */
+class TrajectoryStore {
+  public:
+    using Batch = std::vector<std::pair<ais::mmsi_t, ais::Position>>;
+
+  private:
+    // 32 MiB per chunk, large enough to be returned to the system once released
+    static constexpr std::size_t STAGING_CHUNK_SIZE = 1U << 21U;
+
+    std::vector<ais::Position, utility::default_init_allocator<ais::Position>> positions_;
+    std::vector<ais::mmsi_t> mmsis_;
+    std::vector<std::size_t> offsets_{0};
+    std::vector<Batch> staged_;
+    bool sorted_ = false;
+
+  public:
+    void append(const Batch& /* batch */);
+
+    void group();
+
+    void sort(unsigned /* n_threads */);
+
+    /*
+     * Whether all trajectories are ordered by time without duplicate times.
+     */
+    [[nodiscard]] bool is_sorted() const noexcept {
+        return sorted_;
+    }
+
+    /*
+     * Number of positions that are staged but not yet grouped.
+     */
+    [[nodiscard]] std::size_t n_staged() const noexcept {
+        return staged_.empty() ? 0
+                               : (staged_.size() - 1) * STAGING_CHUNK_SIZE + staged_.back().size();
+    }
+
+    /*
+     * Removes all staged positions from the store and returns them in the order of their staging.
+     */
+    [[nodiscard]] std::vector<Batch> take_staged() noexcept {
+        return std::exchange(staged_, {});
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return mmsis_.size();
+    }
+
+    [[nodiscard]] ais::mmsi_t mmsi(std::size_t i) const noexcept {
+        return mmsis_[i];
+    }
+
+    [[nodiscard]] std::span<ais::Position> trajectory(std::size_t i) noexcept {
+        return std::span{positions_}.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    [[nodiscard]] ais::TrajectoryView trajectory(std::size_t i) const noexcept {
+        return ais::TrajectoryView{positions_}.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+};
+}   // namespace seqmaker
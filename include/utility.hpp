@@ -2,21 +2,97 @@
 
 #include "function_traits.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <charconv>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace seqmaker::utility {
+/*
+ * Allocator that default-initializes instead of value-initializes elements, i.e., resizing a
+ * vector of trivial types leaves the new elements uninitialized and their memory untouched.
+ */
+template <typename T> struct default_init_allocator: std::allocator<T> {
+    template <typename U> struct rebind {
+        using other = default_init_allocator<U>;
+    };
+
+    using std::allocator<T>::allocator;
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
 template <typename TO> [[nodiscard]] TO to(std::string_view from, TO fallback) noexcept {
     std::from_chars(from.data(), from.data() + from.size(), fallback);
     return fallback;
 }
 
+/*
+ * cf. std::stod, since std::from_chars for double is not supported by all compilers, where the
+ * whole string has to be a number that is within the range of double.
+ */
+template <> [[nodiscard]] inline double to(std::string_view from, double fallback) noexcept {
+    try {
+        std::size_t n = 0;
+        const auto x = std::stod(std::string{from}, &n);
+        return n == from.size() ? x : fallback;
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
 namespace detail {
+    constexpr std::uint64_t repeat_byte(std::uint8_t byte) noexcept {
+        return std::uint64_t{byte} * 0x0101010101010101ULL;
+    }
+
+    /*
+     * Marks the bytes of w (in little endian order) that are no decimal digits by a non-zero high
+     * nibble. Bytes after the first marked byte may be marked wrongly.
+     */
+    [[nodiscard]] constexpr std::uint64_t non_digits(std::uint64_t w) noexcept {
+        const auto x = w ^ repeat_byte('0');   // digits become 0, ..., 9
+        return (x | (x + repeat_byte(6))) & repeat_byte(0xF0);
+    }
+
+    /*
+     * Value of eight decimal digits in little endian order, i.e., the first digit is the lowest
+     * byte of w.
+     */
+    [[nodiscard]] constexpr std::uint64_t eight_digits(std::uint64_t w) noexcept {
+        constexpr std::uint64_t MASK = 0x000000FF000000FFULL;
+        constexpr std::uint64_t MUL1 = 100 + (1000000ULL << 32U);
+        constexpr std::uint64_t MUL2 = 1 + (10000ULL << 32U);
+
+        w -= repeat_byte('0');
+        w = w * 10 + (w >> 8U);   // NOLINT
+        return (((w & MASK) * MUL1) + (((w >> 16U) & MASK) * MUL2)) >> 32U;
+    }
+
     template <typename F, std::size_t... I>
     [[nodiscard]] auto split_map(std::string_view line,
                                  std::string_view delimiter,
@@ -69,18 +145,74 @@ template <typename Lambda>
     return detail::split_map(line, delimiter, map, std::make_index_sequence<N>{});
 }
 
+/*
+ * Same as to<T> for integral types, i.e., decodes the leading digits of from with an optional
+ * minus sign for signed types and returns fallback if there are none or the value is out of
+ * range. If at least 17 bytes can be read from the start of from, i.e., n_readable >= 17, up to 16
+ * digits are decoded with a fixed number of operations on 64 bit words.
+ */
 template <typename T>
-[[nodiscard]] inline std::optional<T> time_recorded(std::string_view recv_seconds,
-                                                    std::string_view slot_seconds) noexcept {
-    auto recv = to<T>(recv_seconds, 0);
+[[nodiscard]] T to_integer(std::string_view from, T fallback, std::size_t n_readable = 0) noexcept {
+    static_assert(std::is_integral_v<T> and sizeof(T) <= sizeof(std::uint32_t));
+    constexpr std::size_t N = 2 * sizeof(std::uint64_t);
+    if (std::endian::native != std::endian::little or n_readable < N + 1) {
+        return to<T>(from, fallback);
+    }
 
-    constexpr signed slot_max_value = 59;
-    auto slot = to<signed>(slot_seconds, slot_max_value + 1);
+    const auto negative = std::is_signed_v<T> and not from.empty() and from.front() == '-';
+    const auto* p = negative ? std::next(from.data()) : from.data();
+    const auto n = from.size() - (negative ? 1 : 0);
 
-    if (recv == 0 || slot > slot_max_value) {
-        return std::nullopt;
+    auto load = [](const char* q) {
+        std::uint64_t w;   // NOLINT
+        std::memcpy(&w, q, sizeof(w));
+        return w;
+    };
+
+    // marks the bytes beyond the string as no digits
+    auto beyond = [n](std::size_t first) {
+        return n <= first ? ~std::uint64_t{0}
+                          : (n >= first + 8 ? 0 : ~std::uint64_t{0} << (8 * (n - first)));
+    };
+    const auto m0 = detail::non_digits(load(p)) | beyond(0);
+    const auto m1 = detail::non_digits(load(std::next(p, 8))) | beyond(8);
+
+    auto n_leading_digits = [](std::uint64_t m) {
+        return static_cast<std::size_t>(std::countr_zero(m)) / 8;
+    };
+    const auto n_digits = m0 != 0 ? n_leading_digits(m0) : 8 + n_leading_digits(m1);
+    if (n_digits == 0) {
+        return fallback;
     }
+    const auto is_digit = [](char c) { return static_cast<unsigned char>(c - '0') < 10; };
+    if (n_digits == N and n > N and is_digit(*std::next(p, static_cast<std::ptrdiff_t>(N)))) {
+        // more digits than fit into two words
+        return to<T>(from, fallback);
+    }
+
+    // the first k digits right-aligned in a word of zeros
+    auto leading = [&load, p](std::size_t k) {
+        const auto shift = 8 * (8 - k);
+        return (load(p) << shift) | (detail::repeat_byte('0') & ~(~std::uint64_t{0} << shift));
+    };
+    constexpr std::uint64_t E8 = 100000000;
+    auto value = detail::eight_digits(leading(std::min<std::size_t>(n_digits, 8)));
+    if (n_digits > 8) {
+        const auto* last = std::next(p, static_cast<std::ptrdiff_t>(n_digits - 8));
+        value = detail::eight_digits(leading(n_digits - 8)) * E8 + detail::eight_digits(load(last));
+    }
+
+    constexpr auto MAX = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    if (negative) {
+        return value > MAX + 1 ? fallback : static_cast<T>(-static_cast<std::int64_t>(value));
+    }
+    return value > MAX ? fallback : static_cast<T>(value);
+}
 
+/*
+ * Corrects the reception time recv (in seconds) to the closest time with the given slot second.
+ */
+template <typename T> [[nodiscard]] constexpr T slot_corrected(T recv, signed slot) noexcept {
     constexpr signed ONE_MINUTE = 60;
     const auto sec = static_cast<signed>(recv % static_cast<T>(ONE_MINUTE));
 
@@ -94,12 +226,24 @@ template <typename T>
         return 0;
     }(slot - sec);
 
+    // modular arithmetic of unsigned integers, i.e., subtracting a negative dt adds its magnitude
     const auto dt = sec - slot - slot_correction;
-    if (dt < 0) {
-        return recv + static_cast<T>(-dt);
+    return recv - static_cast<T>(dt);
+}
+
+template <typename T>
+[[nodiscard]] inline std::optional<T> time_recorded(std::string_view recv_seconds,
+                                                    std::string_view slot_seconds) noexcept {
+    auto recv = to<T>(recv_seconds, 0);
+
+    constexpr signed slot_max_value = 59;
+    auto slot = to<signed>(slot_seconds, slot_max_value + 1);
+
+    if (recv == 0 || slot > slot_max_value) {
+        return std::nullopt;
     }
 
-    return recv - static_cast<T>(dt);
+    return slot_corrected(recv, slot);
 }
 
 template <typename InputIt, typename OutputIt, typename BinaryOperation>
@@ -121,4 +265,71 @@ low_pass_filter(InputIt first, InputIt last, OutputIt d_first, BinaryOperation b
 
     return d_first;
 }
+
+/*
+ * cf. low_pass_filter, where is_valid(i) is passed the index of the first element of each pair of
+ * adjacent elements (i, i + 1) of [first, last) instead of the elements, e.g., to look up
+ * precomputed differences. Elements may be written to d_first = first.
+ */
+template <typename RandomIt, typename OutputIt, typename Predicate>
+[[nodiscard]] auto low_pass_filter_by_index(RandomIt first,
+                                            RandomIt last,
+                                            OutputIt d_first,
+                                            Predicate is_valid) noexcept {
+    const auto n = static_cast<std::size_t>(std::distance(first, last));
+    if (n > 1) {
+        auto acc = 1;
+        for (std::size_t i = 0; i + 1 < n; i++) {
+            acc = is_valid(i) ? 0 : (acc + 1);
+            if (acc < 2) {
+                *d_first++ = first[static_cast<std::ptrdiff_t>(i)];
+            }
+        }
+
+        if (acc < 1) {
+            *d_first++ = first[static_cast<std::ptrdiff_t>(n - 1)];
+        }
+    }
+
+    return d_first;
+}
+
+/*
+ * Calls f(worker, i) for each i in [0, n) using up to n_workers threads. Tasks are handed out in
+ * ascending order of i to the next idle worker. If any call throws, no further tasks are started
+ * and the exception of the lowest worker index is rethrown once all workers have finished.
+ */
+template <typename F> void parallel_for(std::size_t n, unsigned n_workers, F&& f) {
+    if (n_workers <= 1 or n <= 1) {
+        for (std::size_t i = 0; i < n; i++) {
+            f(0U, i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::vector<std::exception_ptr> errors(n_workers);
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(n_workers);
+        for (auto worker = 0U; worker < n_workers; worker++) {
+            workers.emplace_back([&f, &next, &errors, n, worker]() {
+                try {
+                    for (auto i = next++; i < n; i = next++) {
+                        f(worker, i);
+                    }
+                } catch (...) {
+                    errors[worker] = std::current_exception();
+                    next = n;
+                }
+            });
+        }
+    }
+
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
 }   // namespace seqmaker::utility
@@ -1,11 +1,184 @@
 #include "ais.hpp"
 
-#include "utility.hpp"
+#include "intrinsics.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <numeric>
+#include <type_traits>
 
 namespace seqmaker::ais {
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double AIS_PER_DEG = 600000.;
+    constexpr double NM_PER_AIS = 60. / AIS_PER_DEG;
+
+    // the mean latitude of two points in radians is their latitude sum times this factor
+    constexpr double RAD_PER_AIS_SUM = PI / 180. / AIS_PER_DEG / 2.;
+
+    // Taylor coefficients of cos(y) in powers of y^2, truncation error below 7e-9 for |y| <= pi/2
+    constexpr std::array<double, 7> COS_COEFFS{
+        1., -1. / 2., 1. / 24., -1. / 720., 1. / 40320., -1. / 3628800., 1. / 479001600.};
+
+    /*
+     * a * b + c, which is rounded once as by the vector kernels wherever they are available.
+     */
+    [[nodiscard]] double fmadd(double a, double b, double c) noexcept {
+#if defined(__FMA__)
+        return std::fma(a, b, c);
+#else
+        return a * b + c;
+#endif
+    }
+
+    /*
+     * Approximates |cos(m)| for |m| <= pi, where the sign does not matter for distances.
+     */
+    [[nodiscard]] double fast_cos(double m) noexcept {
+        const auto y = std::min(std::abs(m), PI - std::abs(m));
+        const auto y2 = y * y;
+
+        auto c = COS_COEFFS.back();
+        for (auto it = std::next(COS_COEFFS.rbegin()); it != COS_COEFFS.rend(); it++) {
+            c = fmadd(c, y2, *it);
+        }
+        return c;
+    }
+
+    /*
+     * Equirectangular distance in nautical miles, or its square if SQUARED is set. The operations
+     * are the same as of the vector kernels, i.e., the results are identical.
+     */
+    template <bool SQUARED>
+    [[nodiscard]] double fast_dist_nm(std::int32_t lat1,
+                                      std::int32_t lon1,
+                                      std::int32_t lat2,
+                                      std::int32_t lon2) noexcept {
+        const auto dlat = static_cast<double>(lat1 - lat2);
+        const auto dlon = static_cast<double>(lon1 - lon2);
+        const auto c_dlon = fast_cos(static_cast<double>(lat1 + lat2) * RAD_PER_AIS_SUM) * dlon;
+        const auto d2 = fmadd(dlat, dlat, c_dlon * c_dlon);
+        if constexpr (SQUARED) {
+            return d2 * (NM_PER_AIS * NM_PER_AIS);
+        } else {
+            return std::sqrt(d2) * NM_PER_AIS;
+        }
+    }
+
+    /*
+     * Computes n distances between the elements i and (i + stride) of an array whose elements
+     * start with latitude and longitude and are E 32 bit integers wide, where x points to the
+     * latitude of the first element. Squared distances are computed if SQUARED is set.
+     */
+    template <int E, bool SQUARED>
+    void dist_nm_kernel(const std::int32_t* x, std::size_t n, std::size_t stride, double* out) {
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto* y = x + stride * E;
+        std::size_t i = 0;
+
+#if defined(__AVX512F__)
+        {
+            constexpr std::size_t W = 8;
+            const auto idx = _mm256_setr_epi32(0, E, 2 * E, 3 * E, 4 * E, 5 * E, 6 * E, 7 * E);
+            for (; i + W <= n; i += W) {
+                const auto* xi = x + i * E;
+                const auto* yi = y + i * E;
+                const auto lat1 = _mm256_i32gather_epi32(xi, idx, sizeof(std::int32_t));
+                const auto lon1 = _mm256_i32gather_epi32(xi + 1, idx, sizeof(std::int32_t));
+                const auto lat2 = _mm256_i32gather_epi32(yi, idx, sizeof(std::int32_t));
+                const auto lon2 = _mm256_i32gather_epi32(yi + 1, idx, sizeof(std::int32_t));
+
+                const auto dlat = _mm512_cvtepi32_pd(_mm256_sub_epi32(lat1, lat2));
+                const auto dlon = _mm512_cvtepi32_pd(_mm256_sub_epi32(lon1, lon2));
+                const auto m = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm256_add_epi32(lat1, lat2)),
+                                             _mm512_set1_pd(RAD_PER_AIS_SUM));
+
+                const auto abs_m = _mm512_abs_pd(m);
+                const auto v = _mm512_min_pd(abs_m, _mm512_sub_pd(_mm512_set1_pd(PI), abs_m));
+                const auto v2 = _mm512_mul_pd(v, v);
+
+                auto c = _mm512_set1_pd(COS_COEFFS.back());
+                for (auto it = std::next(COS_COEFFS.rbegin()); it != COS_COEFFS.rend(); it++) {
+                    c = _mm512_fmadd_pd(c, v2, _mm512_set1_pd(*it));
+                }
+
+                const auto c_dlon = _mm512_mul_pd(c, dlon);
+                const auto d2 = _mm512_fmadd_pd(dlat, dlat, _mm512_mul_pd(c_dlon, c_dlon));
+                if constexpr (SQUARED) {
+                    _mm512_storeu_pd(
+                        out + i, _mm512_mul_pd(d2, _mm512_set1_pd(NM_PER_AIS * NM_PER_AIS)));
+                } else {
+                    _mm512_storeu_pd(
+                        out + i, _mm512_mul_pd(_mm512_sqrt_pd(d2), _mm512_set1_pd(NM_PER_AIS)));
+                }
+            }
+        }
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+        {
+            constexpr std::size_t W = 4;
+            const auto idx = _mm_setr_epi32(0, E, 2 * E, 3 * E);
+            const auto sign = _mm256_set1_pd(-0.);
+            for (; i + W <= n; i += W) {
+                const auto* xi = x + i * E;
+                const auto* yi = y + i * E;
+                const auto lat1 = _mm_i32gather_epi32(xi, idx, sizeof(std::int32_t));
+                const auto lon1 = _mm_i32gather_epi32(xi + 1, idx, sizeof(std::int32_t));
+                const auto lat2 = _mm_i32gather_epi32(yi, idx, sizeof(std::int32_t));
+                const auto lon2 = _mm_i32gather_epi32(yi + 1, idx, sizeof(std::int32_t));
+
+                const auto dlat = _mm256_cvtepi32_pd(_mm_sub_epi32(lat1, lat2));
+                const auto dlon = _mm256_cvtepi32_pd(_mm_sub_epi32(lon1, lon2));
+                const auto m = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_add_epi32(lat1, lat2)),
+                                             _mm256_set1_pd(RAD_PER_AIS_SUM));
+
+                const auto abs_m = _mm256_andnot_pd(sign, m);
+                const auto v = _mm256_min_pd(abs_m, _mm256_sub_pd(_mm256_set1_pd(PI), abs_m));
+                const auto v2 = _mm256_mul_pd(v, v);
+
+                auto c = _mm256_set1_pd(COS_COEFFS.back());
+                for (auto it = std::next(COS_COEFFS.rbegin()); it != COS_COEFFS.rend(); it++) {
+                    c = _mm256_fmadd_pd(c, v2, _mm256_set1_pd(*it));
+                }
+
+                const auto c_dlon = _mm256_mul_pd(c, dlon);
+                const auto d2 = _mm256_fmadd_pd(dlat, dlat, _mm256_mul_pd(c_dlon, c_dlon));
+                if constexpr (SQUARED) {
+                    _mm256_storeu_pd(
+                        out + i, _mm256_mul_pd(d2, _mm256_set1_pd(NM_PER_AIS * NM_PER_AIS)));
+                } else {
+                    _mm256_storeu_pd(
+                        out + i, _mm256_mul_pd(_mm256_sqrt_pd(d2), _mm256_set1_pd(NM_PER_AIS)));
+                }
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            out[i] = fast_dist_nm<SQUARED>(x[i * E], x[i * E + 1], y[i * E], y[i * E + 1]);
+        }
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    template <typename M, int E>
+    void dist_kernel(const std::int32_t* x, std::size_t n, std::size_t stride, double* out) {
+        if constexpr (std::is_same_v<M, Haversine>) {
+            // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const auto* y = x + stride * E;
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = Haversine::dist(Point{.latitude = x[i * E], .longitude = x[i * E + 1]},
+                                         Point{.latitude = y[i * E], .longitude = y[i * E + 1]});
+            }
+            // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } else {
+            dist_nm_kernel<E, std::is_same_v<M, Flat>>(x, n, stride, out);
+        }
+    }
+}   // namespace
 
 [[nodiscard]] double Point::dist_nm(Point other) const noexcept {
     auto ais2deg = [](auto ais) {
@@ -42,20 +215,113 @@ namespace seqmaker::ais {
                  .longitude = intrplt(longitude, other.longitude)};
 }
 
-[[nodiscard]] double acc_dist_nm(const std::vector<Point>& points) noexcept {
-    if (auto n = points.size(); n > 1) {
-        std::vector<double> d;
-        d.reserve(n - 1);
-        // cannot use std::adjacent_difference due to different types ais::Point <-> double
-        utility::adjacent_diff(
-            points.begin(),
-            points.end(),
-            std::back_inserter(d),
-            [](auto a, auto b) { return a.dist_nm(b); },
-            1);
-        return std::reduce(d.begin(), d.end(), 0.);
+[[nodiscard]] std::optional<Metric> to_metric(std::string_view name) noexcept {
+    for (auto metric : {Metric::equirectangular, Metric::haversine, Metric::flat}) {
+        if (name == to_string(metric)) {
+            return metric;
+        }
+    }
+
+    return std::nullopt;
+}
+
+[[nodiscard]] std::string_view to_string(Metric metric) noexcept {
+    switch (metric) {
+    case Metric::haversine:
+        return "haversine";
+    case Metric::flat:
+        return "flat";
+    case Metric::equirectangular:
+        break;
+    }
+
+    return "equirectangular";
+}
+
+[[nodiscard]] double Haversine::dist(Point a, Point b) noexcept {
+    // radius of the sphere on which a minute of arc is one nautical mile
+    constexpr double R_NM = 60. * 180. / PI;
+    constexpr double RAD_PER_AIS = PI / 180. / AIS_PER_DEG;
+
+    const auto lat1 = static_cast<double>(a.latitude) * RAD_PER_AIS;
+    const auto lat2 = static_cast<double>(b.latitude) * RAD_PER_AIS;
+    const auto sin_dlat = std::sin(static_cast<double>(a.latitude - b.latitude) * RAD_PER_AIS / 2.);
+    const auto sin_dlon
+        = std::sin(static_cast<double>(a.longitude - b.longitude) * RAD_PER_AIS / 2.);
+
+    const auto h = sin_dlat * sin_dlat + std::cos(lat1) * std::cos(lat2) * sin_dlon * sin_dlon;
+    return 2. * R_NM * std::asin(std::sqrt(std::min(h, 1.)));
+}
+
+[[nodiscard]] double Equirectangular::dist(Point a, Point b) noexcept {
+    return fast_dist_nm<false>(a.latitude, a.longitude, b.latitude, b.longitude);
+}
+
+[[nodiscard]] double Flat::dist(Point a, Point b) noexcept {
+    return fast_dist_nm<true>(a.latitude, a.longitude, b.latitude, b.longitude);
+}
+
+template <typename M>
+void adjacent_dist(std::span<const Point> points,
+                   std::span<double> out,
+                   std::size_t stride) noexcept {
+    static_assert(std::is_standard_layout_v<Point> and sizeof(Point) == 2 * sizeof(std::int32_t));
+    static_assert(offsetof(Point, latitude) == 0 and offsetof(Point, longitude) == 4);
+
+    if (points.size() > stride) {
+        const auto* x = reinterpret_cast<const std::int32_t*>(points.data());   // NOLINT
+        dist_kernel<M, 2>(x, points.size() - stride, stride, out.data());
     }
+}
+
+template <typename M>
+void adjacent_dist(TrajectoryView trajectory, std::span<double> out, std::size_t stride) noexcept {
+    static_assert(std::is_standard_layout_v<Position>
+                  and sizeof(Position) == 3 * sizeof(std::int32_t));
+    static_assert(offsetof(Position, x) == 4);
 
-    return 0.;
+    if (trajectory.size() > stride) {
+        // NOLINTNEXTLINE
+        const auto* x = reinterpret_cast<const std::int32_t*>(trajectory.data()) + 1;
+        dist_kernel<M, 3>(x, trajectory.size() - stride, stride, out.data());
+    }
 }
+
+template <typename M>
+[[nodiscard]] double acc_dist_nm(std::span<const Point> points, double limit) noexcept {
+    // distances are computed in chunks on the stack, after each of which the limit is checked
+    constexpr std::size_t CHUNK_SIZE = 64;
+    std::array<double, CHUNK_SIZE> d;   // NOLINT
+
+    auto sum = 0.;
+    for (std::size_t i = 0; i + 1 < points.size() and sum < limit; i += CHUNK_SIZE) {
+        const auto chunk = points.subspan(i, std::min(CHUNK_SIZE + 1, points.size() - i));
+        const auto dc = std::span{d}.first(chunk.size() - 1);
+        adjacent_dist<M>(chunk, dc);
+        if constexpr (std::is_same_v<M, Flat>) {
+            std::transform(dc.begin(), dc.end(), dc.begin(), [](auto x) { return M::to_nm(x); });
+        }
+        sum = std::reduce(dc.begin(), dc.end(), sum);
+    }
+
+    return sum;
+}
+
+template void adjacent_dist<Equirectangular>(std::span<const Point>,
+                                             std::span<double>,
+                                             std::size_t) noexcept;
+template void adjacent_dist<Haversine>(std::span<const Point>,
+                                       std::span<double>,
+                                       std::size_t) noexcept;
+template void adjacent_dist<Flat>(std::span<const Point>, std::span<double>, std::size_t) noexcept;
+
+template void adjacent_dist<Equirectangular>(TrajectoryView,
+                                             std::span<double>,
+                                             std::size_t) noexcept;
+template void adjacent_dist<Haversine>(TrajectoryView, std::span<double>, std::size_t) noexcept;
+template void adjacent_dist<Flat>(TrajectoryView, std::span<double>, std::size_t) noexcept;
+
+template double acc_dist_nm<Equirectangular>(std::span<const Point>, double) noexcept;
+template double acc_dist_nm<Haversine>(std::span<const Point>, double) noexcept;
+template double acc_dist_nm<Flat>(std::span<const Point>, double) noexcept;
 }   // namespace seqmaker::ais
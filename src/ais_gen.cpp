@@ -0,0 +1,465 @@
+#include "ais_gen.hpp"
+
+#include "trajectory_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace seqmaker::gen {
+namespace {
+    // 2016-03-01T00:00:00Z
+    constexpr std::uint64_t T0 = 1456790400;
+
+    constexpr unsigned SECONDS_PER_DAY = 86400;
+    constexpr unsigned MOORED_INTERVAL = 180;
+    constexpr double UNITS_PER_NM = 10000.;          // 1/10000 min of latitude
+    constexpr double UNITS_PER_DEGREE = 600000.;     // 1/10000 min
+    constexpr double MAX_ABS_LATITUDE = 80. * UNITS_PER_DEGREE;
+    constexpr double MIN_SPEED = 5.;                  // kt
+    constexpr double MAX_SPEED = 20.;                 // kt
+    constexpr double MAX_TURN = 5. * std::numbers::pi / 180.;
+    constexpr double ANCHOR_SCATTER = 10.;            // 1/10000 min
+
+    // a gap adds between dt_max + 1 and 10 * dt_max seconds to the interval of a vessel
+    constexpr unsigned MAX_GAP_FACTOR = 10;
+
+    // MMSIs are drawn from [MIN_MMSI, MIN_MMSI + N_MMSIS)
+    constexpr std::uint64_t MIN_MMSI = 200000000;
+    constexpr std::uint64_t N_MMSIS = 600000000;
+
+    /*
+     * SplitMix64, i.e., a fast random stream with a state of 64 bits that passes BigCrush.
+     */
+    class Rng {
+      private:
+        std::uint64_t state_;
+
+      public:
+        explicit Rng(std::uint64_t seed) noexcept : state_(seed) {
+        }
+
+        std::uint64_t operator()() noexcept {
+            auto z = (state_ += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31U);
+        }
+
+        // in [0, 1)
+        double uniform() noexcept {
+            constexpr double SCALE = 0x1.0p-53;
+            return static_cast<double>((*this)() >> 11U) * SCALE;
+        }
+
+        double uniform(double a, double b) noexcept {
+            return a + (b - a) * uniform();
+        }
+
+        // in [0, n) for n < 2^53
+        std::uint64_t below(std::uint64_t n) noexcept {
+            return static_cast<std::uint64_t>(uniform() * static_cast<double>(n));
+        }
+
+        bool bernoulli(double p) noexcept {
+            return uniform() < p;
+        }
+    };
+
+    struct Row {
+        std::uint64_t t;
+        std::uint64_t recv_ms;
+        ais::mmsi_t mmsi;
+        unsigned slot;
+        ais::Point::value_type latitude;
+        ais::Point::value_type longitude;
+        enum class Kind { valid, duplicate, invalid } kind;
+    };
+
+    /*
+     * The reports of a vessel in order of time.
+     */
+    class Track {
+      private:
+        const gen_args* args_;
+        Generator::Vessel vessel_;
+        Rng rng_;
+        std::uint64_t t_;
+        std::uint64_t n_left_;
+        double latitude_;    // 1/10000 min
+        double longitude_;   // 1/10000 min
+        double speed_;       // 1/10000 min per second
+        double course_;      // rad, clockwise from north
+
+        void advance() {
+            auto dt = std::uint64_t{vessel_.interval};
+            if (rng_.bernoulli(args_->p_gap)) {
+                dt += args_->dt_max + 1 + rng_.below((MAX_GAP_FACTOR - 1) * args_->dt_max);
+            }
+            t_ += dt;
+
+            constexpr auto MAX_TIME = std::numeric_limits<ais::time_t>::max() - 60;
+            if (t_ > MAX_TIME) {
+                throw std::invalid_argument(
+                    "The synthetic reports exceed the range of times. Reduce the number of days "
+                    "or the probability of gaps.");
+            }
+
+            if (vessel_.moored) {
+                return;
+            }
+
+            course_ += rng_.uniform(-MAX_TURN, MAX_TURN);
+            const auto ds = speed_ * static_cast<double>(dt);
+            latitude_ += ds * std::cos(course_);
+            if (std::abs(latitude_) > MAX_ABS_LATITUDE) {
+                // turn back towards the equator
+                latitude_ = std::copysign(MAX_ABS_LATITUDE, latitude_);
+                course_ = std::numbers::pi - course_;
+            }
+            longitude_ += ds * std::sin(course_) / cos_latitude();
+            constexpr auto FULL_TURN = 360. * UNITS_PER_DEGREE;
+            if (longitude_ >= FULL_TURN / 2) {
+                longitude_ -= FULL_TURN;
+            } else if (longitude_ < -FULL_TURN / 2) {
+                longitude_ += FULL_TURN;
+            }
+        }
+
+        [[nodiscard]] double cos_latitude() const noexcept {
+            return std::cos(latitude_ / UNITS_PER_DEGREE * std::numbers::pi / 180.);
+        }
+
+        [[nodiscard]] std::uint64_t recv_ms(std::uint64_t t) noexcept {
+            constexpr double MS = 1000.;
+            return t * 1000 + static_cast<std::uint64_t>(rng_.uniform(0., args_->jitter * MS));
+        }
+
+      public:
+        Track(const gen_args& args, const Generator::Vessel& vessel)
+            : args_(&args)
+            , vessel_(vessel)
+            , rng_(args.seed ^ (std::uint64_t{static_cast<std::uint32_t>(vessel.mmsi)} << 32U))
+            , t_(vessel.start)
+            , n_left_(vessel.n) {
+            constexpr double KT = UNITS_PER_NM / 3600.;
+            latitude_ = rng_.uniform(-60., 60.) * UNITS_PER_DEGREE;     // NOLINT
+            longitude_ = rng_.uniform(-180., 180.) * UNITS_PER_DEGREE;   // NOLINT
+            speed_ = rng_.uniform(MIN_SPEED, MAX_SPEED) * KT;
+            course_ = rng_.uniform(0., 2. * std::numbers::pi);
+        }
+
+        [[nodiscard]] bool done() const noexcept {
+            return n_left_ == 0;
+        }
+
+        [[nodiscard]] std::uint64_t time() const noexcept {
+            return t_;
+        }
+
+        /*
+         * Passes the rows of the next report to emit, i.e., the valid row followed by a duplicate
+         * reception or an invalid row, if any.
+         */
+        template <typename F> void report(F&& emit) {
+            auto latitude = latitude_;
+            auto longitude = longitude_;
+            if (vessel_.moored) {
+                latitude += rng_.uniform(-ANCHOR_SCATTER, ANCHOR_SCATTER);
+                longitude += rng_.uniform(-ANCHOR_SCATTER, ANCHOR_SCATTER);
+            }
+            if (rng_.bernoulli(args_->p_jump)) {
+                const auto ds = rng_.uniform(2., 10.) * args_->ds_max * UNITS_PER_NM;   // NOLINT
+                const auto phi = rng_.uniform(0., 2. * std::numbers::pi);
+                latitude = std::clamp(latitude + ds * std::cos(phi),
+                                      double{ais::Point::MIN_LATITUDE},
+                                      double{ais::Point::MAX_LATITUDE});
+                longitude = std::clamp(longitude + ds * std::sin(phi) / cos_latitude(),
+                                       double{ais::Point::MIN_LONGITUDE},
+                                       double{ais::Point::MAX_LONGITUDE});
+            }
+
+            Row row{.t = t_,
+                    .recv_ms = recv_ms(t_),
+                    .mmsi = vessel_.mmsi,
+                    .slot = static_cast<unsigned>(t_ % 60),   // NOLINT
+                    .latitude = static_cast<ais::Point::value_type>(std::lround(latitude)),
+                    .longitude = static_cast<ais::Point::value_type>(std::lround(longitude)),
+                    .kind = Row::Kind::valid};
+            emit(row);
+
+            if (rng_.bernoulli(args_->p_duplicate)) {
+                auto duplicate = row;
+                duplicate.recv_ms = recv_ms(t_);
+                duplicate.kind = Row::Kind::duplicate;
+                emit(duplicate);
+            }
+
+            if (rng_.bernoulli(args_->p_invalid)) {
+                auto invalid = row;
+                invalid.kind = Row::Kind::invalid;
+                switch (rng_.below(4)) {   // NOLINT
+                case 0:
+                    invalid.mmsi = static_cast<ais::mmsi_t>(rng_.below(MIN_MMSI));
+                    break;
+                case 1:
+                    invalid.latitude = ais::Point::MAX_LATITUDE + 1
+                                       + static_cast<ais::Point::value_type>(rng_.below(1000));
+                    break;
+                case 2:
+                    invalid.slot = 60 + static_cast<unsigned>(rng_.below(40));   // NOLINT
+                    break;
+                default:
+                    // a reception time of 0 seconds
+                    invalid.recv_ms = rng_.below(1000);   // NOLINT
+                    break;
+                }
+                emit(invalid);
+            }
+
+            if (--n_left_ > 0) {
+                advance();
+            }
+        }
+    };
+
+    /*
+     * Formats rows as lines of AIS data into a buffer, which is passed to a sink once full.
+     */
+    class CsvBuffer {
+      private:
+        static constexpr std::size_t CAPACITY = std::size_t{1} << 20U;
+        static constexpr std::size_t MAX_LINE = 256;
+
+        const Generator::Sink* sink_;
+        std::string_view delimiter_;
+        std::vector<char> buffer_;
+        std::size_t size_ = 0;
+
+        template <typename T> void put(T x) noexcept {
+            auto* first = std::next(buffer_.data(), static_cast<std::ptrdiff_t>(size_));
+            const auto [last, ec] = std::to_chars(first, std::next(first, MAX_LINE), x);
+            size_ += static_cast<std::size_t>(last - first);
+        }
+
+        void put(std::string_view str) noexcept {
+            const auto first = std::next(buffer_.begin(), static_cast<std::ptrdiff_t>(size_));
+            std::copy(str.begin(), str.end(), first);
+            size_ += str.size();
+        }
+
+      public:
+        CsvBuffer(const Generator::Sink& sink, std::string_view delimiter)
+            : sink_(&sink)
+            , delimiter_(delimiter)
+            , buffer_(CAPACITY + MAX_LINE + 5 * delimiter.size()) {
+        }
+
+        void append(const Row& row) {
+            const auto ms = static_cast<unsigned>(row.recv_ms % 1000);   // NOLINT
+            put(row.recv_ms / 1000);                                     // NOLINT
+            buffer_[size_++] = '.';
+            buffer_[size_++] = static_cast<char>('0' + ms / 100);         // NOLINT
+            buffer_[size_++] = static_cast<char>('0' + ms / 10 % 10);     // NOLINT
+            buffer_[size_++] = static_cast<char>('0' + ms % 10);          // NOLINT
+            put(delimiter_);
+            put(row.mmsi);
+            put(delimiter_);
+            put(row.slot);
+            put(delimiter_);
+            put(row.latitude);
+            put(delimiter_);
+            put(row.longitude);
+            buffer_[size_++] = '\n';
+
+            if (size_ >= CAPACITY) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (size_ > 0) {
+                (*sink_)(std::string_view{buffer_.data(), size_});
+                size_ = 0;
+            }
+        }
+    };
+}   // namespace
+
+Generator::Generator(gen_args args) : args_(std::move(args)) {
+    const auto span = std::uint64_t{args_.days} * SECONDS_PER_DAY;
+    auto is_probability = [](double p) { return p >= 0. and p <= 1.; };
+    if (args_.n_vessels == 0 or args_.n_vessels > N_MMSIS or args_.days == 0
+        or T0 + 2 * span > std::numeric_limits<ais::time_t>::max() or args_.rates.empty()
+        or std::find(args_.rates.begin(), args_.rates.end(), 0U) != args_.rates.end()
+        or not is_probability(args_.moored) or not(args_.alpha > 0.)
+        or not(args_.jitter >= 0. and args_.jitter < 30.) or not is_probability(args_.p_duplicate)
+        or not is_probability(args_.p_gap) or not is_probability(args_.p_jump)
+        or not is_probability(args_.p_invalid) or args_.dt_max == 0
+        or args_.dt_max > SECONDS_PER_DAY or not(args_.ds_max > 0.)
+        or args_.n_positions > args_.n_vessels * span) {
+        throw std::invalid_argument("Invalid arguments of the synthetic AIS data generator.");
+    }
+
+    Rng rng{args_.seed};
+
+    // distinct MMSIs by an affine permutation of [0, N_MMSIS), whose factor is coprime to
+    // N_MMSIS = 2^9 * 3 * 5^8
+    auto a = rng.below(N_MMSIS) | 1U;
+    while (a % 3 == 0 or a % 5 == 0) {   // NOLINT
+        a += 2;
+    }
+    const auto b = rng.below(N_MMSIS);
+
+    // Pareto distributed weights of the vessels
+    const auto n = args_.n_vessels;
+    std::vector<double> weights(n);
+    for (auto& w : weights) {
+        w = std::pow(1. - rng.uniform(), -1. / args_.alpha);
+    }
+
+    // positions in proportion to the weights, where vessels that would report more than once per
+    // second are capped and their excess is distributed among the others
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&weights](auto i, auto j) {
+        return weights[i] > weights[j] or (weights[i] == weights[j] and i < j);
+    });
+
+    std::vector<std::uint64_t> counts(n, 0);
+    auto n_left = args_.n_positions;
+    auto w_left = std::accumulate(weights.begin(), weights.end(), 0.);
+    auto share = [&n_left, &w_left, &weights](std::size_t i) {
+        return static_cast<double>(n_left) * weights[i] / w_left;
+    };
+    std::size_t k = 0;
+    for (; k < n and share(order[k]) > static_cast<double>(span); k++) {
+        counts[order[k]] = span;
+        n_left -= span;
+        w_left -= weights[order[k]];
+    }
+
+    std::uint64_t n_assigned = 0;
+    for (auto i = k; i < n; i++) {
+        counts[order[i]] = std::min(static_cast<std::uint64_t>(share(order[i])), span);
+        n_assigned += counts[order[i]];
+    }
+    for (auto i = k; n_assigned < n_left; i = i + 1 < n ? i + 1 : k) {
+        if (counts[order[i]] < span) {
+            counts[order[i]]++;
+            n_assigned++;
+        }
+    }
+
+    for (std::size_t i = 0; i < n; i++) {
+        const auto moored = rng.bernoulli(args_.moored);
+        const auto rate = args_.rates[rng.below(args_.rates.size())];
+        auto interval = std::uint64_t{moored ? MOORED_INTERVAL : rate};
+        if (counts[i] > 0 and counts[i] * interval > span) {
+            interval = span / counts[i];
+        }
+        const auto start = T0 + rng.below(span - counts[i] * interval + 1);
+
+        if (counts[i] > 0) {
+            vessels_.emplace_back(
+                Vessel{.mmsi = static_cast<ais::mmsi_t>(MIN_MMSI + (a * i + b) % N_MMSIS),
+                       .n = counts[i],
+                       .start = static_cast<ais::time_t>(start),
+                       .interval = static_cast<unsigned>(interval),
+                       .moored = moored});
+        }
+    }
+
+    std::sort(vessels_.begin(), vessels_.end(), [](const auto& x, const auto& y) {
+        return x.mmsi < y.mmsi;
+    });
+}
+
+void Generator::write_csv(const Sink& sink) const {
+    std::vector<Track> tracks;
+    tracks.reserve(vessels_.size());
+    std::uint64_t max_interval = 0;
+    for (const auto& vessel : vessels_) {
+        tracks.emplace_back(args_, vessel);
+        max_interval = std::max<std::uint64_t>(max_interval, vessel.interval);
+    }
+
+    std::vector<std::uint32_t> order(vessels_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](auto i, auto j) {
+        return vessels_[i].start < vessels_[j].start;
+    });
+
+    // vessels wait in a ring of buckets for the second of their next report, where the ring
+    // spans the longest step of any vessel
+    const auto max_step = max_interval + std::uint64_t{MAX_GAP_FACTOR} * args_.dt_max;
+    const auto mask = std::bit_ceil(max_step + 1) - 1;
+    std::vector<std::vector<std::uint32_t>> buckets(mask + 1);
+    std::vector<std::uint32_t> due;
+
+    CsvBuffer buffer{sink, args_.delimiter};
+    auto emit = [&buffer](const Row& row) { buffer.append(row); };
+
+    std::size_t next = 0;
+    std::size_t n_done = 0;
+    for (auto t = T0; n_done < tracks.size(); t++) {
+        for (; next < order.size() and vessels_[order[next]].start == t; next++) {
+            buckets[t & mask].emplace_back(order[next]);
+        }
+
+        std::swap(due, buckets[t & mask]);
+        for (auto i : due) {
+            tracks[i].report(emit);
+            if (tracks[i].done()) {
+                n_done++;
+            } else {
+                buckets[tracks[i].time() & mask].emplace_back(i);
+            }
+        }
+        due.clear();
+    }
+
+    buffer.flush();
+}
+
+void Generator::write_cache(const std::filesystem::path& path) const {
+    std::vector<ais::mmsi_t> mmsis;
+    std::vector<std::uint64_t> offsets{0};
+    for (const auto& vessel : vessels_) {
+        mmsis.emplace_back(vessel.mmsi);
+        offsets.emplace_back(offsets.back() + vessel.n);
+    }
+
+    constexpr std::size_t CHUNK_SIZE = std::size_t{1} << 16U;
+    std::vector<ais::Position> chunk;
+    chunk.reserve(CHUNK_SIZE);
+
+    TrajectoryCache::Writer writer{path, mmsis, offsets};
+    auto emit = [&writer, &chunk](const Row& row) {
+        if (row.kind == Row::Kind::valid) {
+            chunk.emplace_back(ais::Position{
+                .t = static_cast<ais::time_t>(row.t),
+                .x = ais::Point{.latitude = row.latitude, .longitude = row.longitude}});
+            if (chunk.size() == CHUNK_SIZE) {
+                writer.append(chunk);
+                chunk.clear();
+            }
+        }
+    };
+
+    for (const auto& vessel : vessels_) {
+        Track track{args_, vessel};
+        while (not track.done()) {
+            track.report(emit);
+        }
+    }
+    writer.append(chunk);
+    writer.close();
+}
+}   // namespace seqmaker::gen
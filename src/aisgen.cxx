@@ -0,0 +1,306 @@
+#include "ais_gen.hpp"
+#include "argparse.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+static constexpr auto USAGE = R"(aisgen
+
+    Generates synthetic AIS data in the input format of seqmaker and seqdiff, e.g., to test them
+    at scale. The output only depends on the options including the seed, i.e., it is reproducible.
+
+    Vessels are assigned random MMSIs and a number of valid positions that follows a heavy-tailed
+    (Pareto) distribution, where the numbers add up to the value of -n. Underway vessels report at
+    an interval that is drawn from the list of --rates and move at 5 to 20 kt along a slowly
+    turning course, moored vessels report every 3 minutes around their anchor position. No vessel
+    reports more than once per second, i.e., -n may not exceed -v times the seconds of --days.
+    The lines are ordered by the time of their reports, where the reception time lags behind the
+    slot second of a report by up to --jitter seconds.
+
+    On top of the valid positions, there are duplicate receptions and invalid rows (invalid MMSI,
+    position, slot second, or reception time), which are dropped when parsing the data, and there
+    are gaps of more than -t seconds and position jumps of more than -s NM.
+
+    Example:
+        $ ./aisgen -n 100000000 -v 10000 --seed 42 | ./seqmaker -d ", " -j 8
+        Above command generates 10^8 positions of 10^4 vessels and passes them to seqmaker.
+
+        $ ./aisgen -n 100000000 -v 10000 --seed 42 --build-cache "ais.cache"
+        Above command writes the valid positions of the same data to the binary cache file
+        "ais.cache" instead, which equals the one of seqmaker --build-cache for the same data and
+        is read by seqmaker --from-cache.
+
+    Options:
+        -h                Prints this message.
+        -n [number]       Number of valid positions (default 1000000).
+        -v [number]       Number of vessels (default 1000).
+        -d "[delimiter]"  The delimiter used to separate columns (default ", ").
+        -f [file]         The output file (default: standard output).
+        -t [seconds]      Gaps are longer than this temporal threshold (default 60 seconds).
+        -s [NM]           Position jumps are larger than this spatial threshold (default .1 NM).
+        --seed [number]   Seed of the random streams (default 0).
+        --days [number]   Days within which the vessels start reporting (default 30).
+        --moored [fraction]
+                          Fraction of moored vessels (default .3).
+        --rates [seconds] Comma-separated list of report intervals of underway vessels, of which
+                          each vessel picks one at random, e.g., "2,2,10" for two thirds of
+                          vessels reporting every 2 seconds (default "2,6,10,30").
+        --alpha [number]  Shape of the Pareto distribution of the number of positions per vessel,
+                          where smaller values give heavier tails (default 1.5).
+        --jitter [seconds]
+                          Maximal delay of the reception after the slot second (default 2).
+        --duplicates [p]  Probability of a duplicate reception per report (default .01).
+        --gaps [p]        Probability of a gap before a report (default .001).
+        --jumps [p]       Probability of a position jump of a report (default .001).
+        --invalid [p]     Probability of an invalid row per report (default .001).
+        --build-cache [file]
+                          Write the valid positions to a binary cache file (cf. seqmaker
+                          --from-cache) instead of writing lines of AIS data.)";
+
+static constexpr auto ARG_n_DEFAULT = "1000000";
+static constexpr auto ARG_v_DEFAULT = "1000";
+static constexpr auto ARG_d_DEFAULT = ", ";
+static constexpr auto ARG_t_DEFAULT = "60";
+static constexpr auto ARG_s_DEFAULT = ".1";
+static constexpr auto ARG_seed_DEFAULT = "0";
+static constexpr auto ARG_days_DEFAULT = "30";
+static constexpr auto ARG_moored_DEFAULT = ".3";
+static constexpr auto ARG_rates_DEFAULT = "2,6,10,30";
+static constexpr auto ARG_alpha_DEFAULT = "1.5";
+static constexpr auto ARG_jitter_DEFAULT = "2";
+static constexpr auto ARG_duplicates_DEFAULT = ".01";
+static constexpr auto ARG_gaps_DEFAULT = ".001";
+static constexpr auto ARG_jumps_DEFAULT = ".001";
+static constexpr auto ARG_invalid_DEFAULT = ".001";
+
+[[nodiscard]] auto strip_quotes(std::string str) noexcept {
+    if (auto n = str.size(); n > 2 and str.starts_with('\"') and str.ends_with('\"')) {
+        str = str.erase(0, 1);
+        str = str.erase(n - 2, n - 1);
+    }
+    return str;
+}
+
+/*
+ * Intervals of the form "2,6,10", or none if invalid.
+ */
+[[nodiscard]] std::vector<unsigned> to_rates(std::string_view str) noexcept {
+    constexpr int MAX_RATE = 3600;
+
+    std::vector<unsigned> rates;
+    for (std::size_t first = 0; first <= str.size();) {
+        const auto last = std::min(str.find(',', first), str.size());
+        const auto rate = seqmaker::utility::to<int>(str.substr(first, last - first), 0);
+        if (rate <= 0 or rate > MAX_RATE) {
+            return {};
+        }
+        rates.emplace_back(static_cast<unsigned>(rate));
+        first = last + 1;
+    }
+    return rates;
+}
+
+void write_all(int fd, std::string_view bytes) {
+    while (not bytes.empty()) {
+        const auto n = ::write(fd, bytes.data(), bytes.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "standard output");
+        }
+        bytes.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
+
+int main(int argc, const char** argv) {
+    using namespace seqmaker;
+
+    argparse::Argparse args{argc, argv};
+    if (auto zero_args = (args.n_args() == 0); zero_args or args.is_set("-h")) {
+        std::cout << USAGE << '\n';
+        return zero_args ? 1 : 0;
+    }
+
+    if (auto invalid_arg = args.check_args(std::set<std::string>{
+            "-n", "-v", "-d", "-f", "-t", "-s", "--seed", "--days", "--moored", "--rates",
+            "--alpha", "--jitter", "--duplicates", "--gaps", "--jumps", "--invalid",
+            "--build-cache"});
+        invalid_arg) {
+        std::cout << "Unknown argument \"" << *invalid_arg << "\".\n";
+        std::cout << "Use -h to print help.\n";
+        return 1;
+    }
+
+    auto d = strip_quotes(args.get("-d").value_or(std::string{ARG_d_DEFAULT}));
+    if (auto i = d.find("\\t"); i != std::string::npos) {
+        d.replace(i, 2, "\t");
+    }
+
+    try {
+        const auto n = utility::to<std::uint64_t>(args.get("-n").value_or(ARG_n_DEFAULT), 0);
+        const auto v = utility::to<std::uint64_t>(args.get("-v").value_or(ARG_v_DEFAULT), 0);
+        const auto t = utility::to<int>(args.get("-t").value_or(ARG_t_DEFAULT), 0);
+        const auto s = utility::to<double>(args.get("-s").value_or(ARG_s_DEFAULT), 0.);
+        const auto seed = utility::to<std::uint64_t>(
+            args.get("--seed").value_or(ARG_seed_DEFAULT), std::uint64_t{0});
+        const auto days = utility::to<int>(args.get("--days").value_or(ARG_days_DEFAULT), 0);
+        const auto moored
+            = utility::to<double>(args.get("--moored").value_or(ARG_moored_DEFAULT), -1.);
+        const auto rates = to_rates(args.get("--rates").value_or(ARG_rates_DEFAULT));
+        const auto alpha = utility::to<double>(args.get("--alpha").value_or(ARG_alpha_DEFAULT), 0.);
+        const auto jitter
+            = utility::to<double>(args.get("--jitter").value_or(ARG_jitter_DEFAULT), -1.);
+        const auto p_duplicate
+            = utility::to<double>(args.get("--duplicates").value_or(ARG_duplicates_DEFAULT), -1.);
+        const auto p_gap = utility::to<double>(args.get("--gaps").value_or(ARG_gaps_DEFAULT), -1.);
+        const auto p_jump
+            = utility::to<double>(args.get("--jumps").value_or(ARG_jumps_DEFAULT), -1.);
+        const auto p_invalid
+            = utility::to<double>(args.get("--invalid").value_or(ARG_invalid_DEFAULT), -1.);
+        const auto f = std::filesystem::path{strip_quotes(args.get("-f").value_or(""))};
+        const auto build_cache = strip_quotes(args.get("--build-cache").value_or(""));
+
+        constexpr std::uint64_t MAX_VESSELS = 600000000;
+        constexpr int MAX_DAYS = 10000;
+        constexpr int SECONDS_PER_DAY = 86400;
+        auto is_probability = [](double p) { return p >= 0. and p <= 1.; };
+
+        if (n == 0) {
+            std::cerr << "Error: Value of -n has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (v == 0 or v > MAX_VESSELS) {
+            std::cerr << "Error: Value of -v has to be non-zero, positive and at most "
+                      << MAX_VESSELS << '\n';
+            return 1;
+        }
+
+        if (t <= 0 or t > SECONDS_PER_DAY) {
+            std::cerr << "Error: Value of -t has to be non-zero, positive and at most one day\n";
+            return 1;
+        }
+
+        if (s <= 0.) {
+            std::cerr << "Error: Value of -s has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (days <= 0 or days > MAX_DAYS) {
+            std::cerr << "Error: Value of --days has to be non-zero, positive and at most "
+                      << MAX_DAYS << '\n';
+            return 1;
+        }
+
+        if (n > v * static_cast<std::uint64_t>(days) * SECONDS_PER_DAY) {
+            std::cerr << "Error: Value of -n exceeds one position per second of each vessel within "
+                         "--days\n";
+            return 1;
+        }
+
+        if (not is_probability(moored)) {
+            std::cerr << "Error: Value of --moored has to be in [0, 1]\n";
+            return 1;
+        }
+
+        if (rates.empty()) {
+            std::cerr << "Error: Value of --rates has to be a list of intervals in [1, 3600]\n";
+            return 1;
+        }
+
+        if (alpha <= 0.) {
+            std::cerr << "Error: Value of --alpha has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (not(jitter >= 0. and jitter < 30.)) {   // NOLINT
+            std::cerr << "Error: Value of --jitter has to be in [0, 30)\n";
+            return 1;
+        }
+
+        for (auto [name, p] : {std::pair{"--duplicates", p_duplicate},
+                               std::pair{"--gaps", p_gap},
+                               std::pair{"--jumps", p_jump},
+                               std::pair{"--invalid", p_invalid}}) {
+            if (not is_probability(p)) {
+                std::cerr << "Error: Value of " << name << " has to be in [0, 1]\n";
+                return 1;
+            }
+        }
+
+        if (args.is_set("-f") and f.empty()) {
+            std::cerr << "Error: Value of -f has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--build-cache") and build_cache.empty()) {
+            std::cerr << "Error: Value of --build-cache has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--build-cache") and args.is_set("-f")) {
+            std::cerr << "Error: Option --build-cache is incompatible with -f\n";
+            return 1;
+        }
+
+        const gen::Generator generator{gen::gen_args{.n_positions = n,
+                                                     .n_vessels = static_cast<std::size_t>(v),
+                                                     .seed = seed,
+                                                     .days = static_cast<unsigned>(days),
+                                                     .delimiter = d,
+                                                     .moored = moored,
+                                                     .rates = rates,
+                                                     .alpha = alpha,
+                                                     .jitter = jitter,
+                                                     .p_duplicate = p_duplicate,
+                                                     .p_gap = p_gap,
+                                                     .p_jump = p_jump,
+                                                     .p_invalid = p_invalid,
+                                                     .dt_max = static_cast<unsigned>(t),
+                                                     .ds_max = s}};
+
+        if (args.is_set("--build-cache")) {
+            generator.write_cache(build_cache);
+            return 0;
+        }
+
+        if (f.empty()) {
+            generator.write_csv([](std::string_view lines) { write_all(STDOUT_FILENO, lines); });
+            return 0;
+        }
+
+        std::ofstream out(f, std::ios::binary | std::ios::trunc);
+        generator.write_csv([&out, &f](std::string_view lines) {
+            if (not out.write(lines.data(), static_cast<std::streamsize>(lines.size()))) {
+                throw std::system_error(errno, std::generic_category(), f.string());
+            }
+        });
+        if (not out.flush()) {
+            throw std::system_error(errno, std::generic_category(), f.string());
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
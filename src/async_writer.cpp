@@ -0,0 +1,108 @@
+#include "async_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+namespace seqmaker::io {
+namespace {
+    void write_file(const std::filesystem::path& path,
+                    const std::vector<char>& bytes,
+                    std::ios::openmode mode) {
+        std::ofstream f(path, std::ios::binary | mode);
+        f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+        // buffered bytes are only flushed by close, which may fail as well, e.g., on a full disk
+        f.close();
+        if (f.fail()) {
+            throw std::system_error(errno, std::generic_category(), path.string());
+        }
+    }
+}   // namespace
+
+AsyncWriter::AsyncWriter(unsigned n_threads, std::size_t capacity)
+    : queues_(std::max(n_threads, 1U))
+    , capacity_(capacity) {
+    threads_.reserve(queues_.size());
+    for (auto& queue : queues_) {
+        threads_.emplace_back([this, &queue]() { drain(queue); });
+    }
+}
+
+AsyncWriter::~AsyncWriter() {
+    try {
+        finish();
+    } catch (...) {
+        // errors are only reported by an explicit call of finish
+    }
+}
+
+void AsyncWriter::drain(Queue& queue) noexcept {
+    while (true) {
+        Job job;
+        bool failed = false;
+        {
+            std::unique_lock lock{mutex_};
+            queue.ready.wait(lock, [this, &queue]() { return done_ or not queue.jobs.empty(); });
+            if (queue.jobs.empty()) {
+                return;
+            }
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            failed = error_ != nullptr;
+        }
+
+        if (not failed) {
+            try {
+                write_file(job.path, job.bytes, job.mode);
+            } catch (...) {
+                const std::lock_guard lock{mutex_};
+                if (not error_) {
+                    error_ = std::current_exception();
+                }
+            }
+        }
+
+        {
+            const std::lock_guard lock{mutex_};
+            n_queued_ -= job.bytes.size();
+        }
+        space_.notify_all();
+    }
+}
+
+void AsyncWriter::write(std::filesystem::path path,
+                        std::vector<char> bytes,
+                        std::ios::openmode mode) {
+    const auto n = bytes.size();
+    auto& queue = queues_[std::filesystem::hash_value(path) % queues_.size()];
+    {
+        std::unique_lock lock{mutex_};
+        space_.wait(lock, [this, n]() { return n_queued_ == 0 or n_queued_ + n <= capacity_; });
+        n_queued_ += n;
+        queue.jobs.emplace_back(
+            Job{.path = std::move(path), .bytes = std::move(bytes), .mode = mode});
+    }
+    queue.ready.notify_one();
+}
+
+void AsyncWriter::finish() {
+    {
+        const std::lock_guard lock{mutex_};
+        done_ = true;
+    }
+    for (auto& queue : queues_) {
+        queue.ready.notify_one();
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    if (auto error = std::exchange(error_, nullptr); error) {
+        std::rethrow_exception(error);
+    }
+}
+}   // namespace seqmaker::io
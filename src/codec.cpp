@@ -0,0 +1,303 @@
+#include "codec.hpp"
+
+#include "intrinsics.hpp"
+#include "io.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace seqmaker::codec {
+namespace {
+    constexpr std::array<char, 4> MAGIC{'A', 'I', 'S', 'Z'};
+
+    constexpr std::uint8_t DELTA = 1U << 0U;
+
+    struct Header {
+        std::array<char, 4> magic;   // NOLINT
+        std::uint8_t version;        // NOLINT
+        std::uint8_t n_columns;      // NOLINT
+        std::uint8_t flags;          // NOLINT
+        std::uint8_t reserved;       // NOLINT
+        std::uint32_t n_rows;        // NOLINT
+    };
+
+    static_assert(sizeof(Header) == 12);
+
+    [[nodiscard]] std::invalid_argument invalid_packed(std::string_view source,
+                                                       std::string_view reason) {
+        return std::invalid_argument("Invalid packed " + std::string{source} + ". "
+                                     + std::string{reason});
+    }
+
+    /*
+     * Number of bytes of n values packed at the given bit width.
+     */
+    [[nodiscard]] constexpr std::size_t packed_size(std::size_t n, unsigned width) noexcept {
+        return (n * width + 7) / 8;
+    }
+
+    template <typename T> void append(std::vector<char>& out, const T* data, std::size_t n) {
+        const auto* bytes = reinterpret_cast<const char*>(data);   // NOLINT
+        out.insert(out.end(), bytes, bytes + n * sizeof(T));       // NOLINT
+    }
+
+    void pack(std::span<const std::uint32_t> values, unsigned width, std::vector<char>& out) {
+        std::uint64_t bits = 0;
+        unsigned n_bits = 0;
+        for (auto x : values) {
+            bits |= std::uint64_t{x} << n_bits;
+            for (n_bits += width; n_bits >= 8; n_bits -= 8) {
+                out.push_back(static_cast<char>(bits & 0xFFU));
+                bits >>= 8U;
+            }
+        }
+
+        if (n_bits > 0) {
+            out.push_back(static_cast<char>(bits));
+        }
+    }
+
+    /*
+     * Inverse of pack for the values starting at first, where bytes has to be readable up to 8
+     * bytes past the packed values. For a given width, each value is read by a single unaligned
+     * load without branches.
+     */
+    void unpack_from(const char* bytes,
+                     unsigned width,
+                     std::span<std::uint32_t> values,
+                     std::size_t first) noexcept {
+        const auto mask = (std::uint64_t{1} << width) - 1;
+        for (auto i = first; i < values.size(); i++) {
+            const auto bit = i * width;
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes + bit / 8, sizeof(word));   // NOLINT
+            values[i] = static_cast<std::uint32_t>((word >> (bit % 8)) & mask);
+        }
+    }
+
+    void encode_frame(std::span<const std::uint32_t> rows,
+                      unsigned n_columns,
+                      bool delta,
+                      std::vector<char>& out) {
+        const auto n_rows = rows.size() / n_columns;
+        const Header header{.magic = MAGIC,
+                            .version = VERSION,
+                            .n_columns = static_cast<std::uint8_t>(n_columns),
+                            .flags = delta ? DELTA : std::uint8_t{0},
+                            .reserved = 0,
+                            .n_rows = static_cast<std::uint32_t>(n_rows)};
+        append(out, &header, 1);
+        append(out, rows.data(), n_columns);
+
+        std::array<std::uint32_t, BLOCK_SIZE> values{};
+        for (std::size_t first = 1; first < n_rows; first += BLOCK_SIZE) {
+            const auto n = std::min(BLOCK_SIZE, n_rows - first);
+            for (std::size_t c = 0; c < n_columns; c++) {
+                std::uint32_t bits = 0;
+                for (std::size_t i = 0; i < n; i++) {
+                    const auto k = (first + i) * n_columns + c;
+                    values[i] = zigzag(delta ? rows[k] - rows[k - n_columns] : rows[k]);
+                    bits |= values[i];
+                }
+
+                const auto width = static_cast<unsigned>(std::numeric_limits<std::uint32_t>::digits
+                                                         - std::countl_zero(bits));
+                out.push_back(static_cast<char>(width));
+                pack({values.data(), n}, width, out);
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<std::uint32_t> decode(std::span<const char> bytes,
+                                                    std::string_view source) {
+        std::vector<std::uint32_t> rows;
+        std::array<std::uint32_t, BLOCK_SIZE> values{};
+        std::array<char, BLOCK_SIZE * sizeof(std::uint32_t) + sizeof(std::uint64_t)> buffer{};
+
+        std::size_t pos = 0;
+        auto take = [&bytes, &pos, source](std::size_t n) {
+            if (bytes.size() - pos < n) {
+                throw invalid_packed(source, "The data are truncated.");
+            }
+            pos += n;
+            return bytes.data() + pos - n;   // NOLINT
+        };
+
+        unsigned n_columns = 0;
+        while (pos < bytes.size()) {
+            Header header{};
+            std::memcpy(&header, take(sizeof(header)), sizeof(header));
+            if (header.magic != MAGIC) {
+                throw invalid_packed(source, "A frame has no valid header.");
+            }
+            if (header.version != VERSION) {
+                throw invalid_packed(source,
+                                     "A frame has version " + std::to_string(header.version)
+                                         + " instead of " + std::to_string(VERSION) + '.');
+            }
+            if (header.n_columns == 0 or (n_columns != 0 and header.n_columns != n_columns)) {
+                throw invalid_packed(source, "The number of columns differs between frames.");
+            }
+            n_columns = header.n_columns;
+
+            const std::size_t n_rows = header.n_rows;
+            if (n_rows == 0) {
+                continue;
+            }
+
+            // each block holds at least the bit width of each column
+            const auto n_blocks = (n_rows - 1 + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            if (bytes.size() - pos < n_columns * (sizeof(std::uint32_t) + n_blocks)) {
+                throw invalid_packed(source, "The data are truncated.");
+            }
+
+            const auto offset = rows.size();
+            rows.resize(offset + n_rows * n_columns);
+            const auto frame = std::span{rows}.subspan(offset);
+            const auto first_size = n_columns * sizeof(std::uint32_t);
+            std::memcpy(frame.data(), take(first_size), first_size);
+
+            const auto delta = (header.flags & DELTA) != 0;
+            for (std::size_t first = 1; first < n_rows; first += BLOCK_SIZE) {
+                const auto n = std::min(BLOCK_SIZE, n_rows - first);
+                for (std::size_t c = 0; c < n_columns; c++) {
+                    const auto width = static_cast<unsigned char>(*take(1));
+                    if (width > std::numeric_limits<std::uint32_t>::digits) {
+                        throw invalid_packed(source, "A block has an invalid bit width.");
+                    }
+
+                    const auto n_bytes = packed_size(n, width);
+                    const auto* packed = take(n_bytes);
+                    if (bytes.size() - pos < sizeof(std::uint64_t)) {
+                        // the end of the data must not be read past
+                        std::memcpy(buffer.data(), packed, n_bytes);
+                        packed = buffer.data();
+                    }
+                    detail::unpack(packed, width, {values.data(), n});
+
+                    for (std::size_t i = 0; i < n; i++) {
+                        const auto k = (first + i) * n_columns + c;
+                        frame[k] = unzigzag(values[i]) + (delta ? frame[k - n_columns] : 0U);
+                    }
+                }
+            }
+        }
+
+        return rows;
+    }
+}   // namespace
+
+namespace detail {
+    void unpack_scalar(const char* bytes,
+                       unsigned width,
+                       std::span<std::uint32_t> values) noexcept {
+        unpack_from(bytes, width, values, 0);
+    }
+
+    void unpack(const char* bytes, unsigned width, std::span<std::uint32_t> values) noexcept {
+        std::size_t i = 0;
+
+#if defined(__AVX2__)
+        // eight values are gathered by 32 bit loads at their first byte, which hold values of up
+        // to 25 bits for any bit offset within this byte
+        constexpr unsigned MAX_GATHER_WIDTH = 25;
+        constexpr std::size_t W = 8;
+        if (width <= MAX_GATHER_WIDTH and values.size() <= std::numeric_limits<int>::max() / W) {
+            const auto w = static_cast<int>(width);
+            const auto mask = _mm256_set1_epi32((1 << w) - 1);
+            const auto seven = _mm256_set1_epi32(7);
+            const auto step = _mm256_set1_epi32(static_cast<int>(W) * w);
+            auto bits = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                           _mm256_set1_epi32(w));
+            const auto* base = reinterpret_cast<const int*>(bytes);   // NOLINT
+            for (; i + W <= values.size(); i += W) {
+                const auto words = _mm256_i32gather_epi32(base, _mm256_srli_epi32(bits, 3), 1);
+                const auto x = _mm256_srlv_epi32(words, _mm256_and_si256(bits, seven));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(values.data() + i),   // NOLINT
+                                    _mm256_and_si256(x, mask));
+                bits = _mm256_add_epi32(bits, step);
+            }
+        }
+#endif
+
+        unpack_from(bytes, width, values, i);
+    }
+}   // namespace detail
+
+std::optional<Format> to_format(std::string_view name) noexcept {
+    for (auto format : {Format::raw, Format::packed}) {
+        if (name == to_string(format)) {
+            return format;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::string_view to_string(Format format) noexcept {
+    switch (format) {
+    case Format::packed:
+        return "packed";
+    case Format::raw:
+        break;
+    }
+
+    return "raw";
+}
+
+std::string_view extension(Format format) noexcept {
+    switch (format) {
+    case Format::packed:
+        return ".pbin";
+    case Format::raw:
+        break;
+    }
+
+    return ".bin";
+}
+
+void encode(std::span<const std::uint32_t> rows,
+            unsigned n_columns,
+            bool delta,
+            std::vector<char>& out) {
+    if (n_columns == 0 or n_columns > std::numeric_limits<std::uint8_t>::max()
+        or rows.size() % n_columns != 0) {
+        throw std::invalid_argument("Invalid number of columns " + std::to_string(n_columns)
+                                    + " for packing.");
+    }
+
+    // the number of rows of a frame is limited by its header
+    constexpr std::size_t MAX_ROWS = std::numeric_limits<std::uint32_t>::max();
+    const auto n_rows = rows.size() / n_columns;
+    for (std::size_t first = 0; first < n_rows; first += MAX_ROWS) {
+        const auto n = std::min(MAX_ROWS, n_rows - first);
+        encode_frame(rows.subspan(first * n_columns, n * n_columns), n_columns, delta, out);
+    }
+}
+
+std::vector<std::uint32_t> decode(std::span<const char> bytes) {
+    return decode(bytes, "stream");
+}
+
+std::vector<std::uint32_t> decode_file(const std::filesystem::path& path) {
+    const io::detail::FileDescriptor fd{path};
+    const auto size = std::filesystem::file_size(path);
+    if (size == 0) {
+        return {};
+    }
+
+    const io::detail::MappedFile file{fd.get(), size};
+    if (not file) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+    const auto bytes = file.view();
+    return decode({bytes.data(), bytes.size()}, "file " + path.string());
+}
+}   // namespace seqmaker::codec
@@ -0,0 +1,79 @@
+#include "histogram.hpp"
+
+#include "utility.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace seqmaker {
+
+Axis::Axis(double min, double max, unsigned n_bins, bool log) noexcept
+    : min_(min)
+    , max_(max)
+    , n_bins_(n_bins)
+    , log_(log)
+    , offset_(log ? std::log(min) : min)
+    , scale_(n_bins / ((log ? std::log(max) : max) - offset_)) {
+}
+
+std::size_t Axis::bin(double x) const noexcept {
+    if (not(x >= min_)) {
+        return 0;
+    }
+    if (x >= max_) {
+        return n_bins_ + std::size_t{1};
+    }
+
+    // rounding may shift values close to max beyond the last bin
+    const auto i = ((log_ ? std::log(x) : x) - offset_) * scale_;
+    return std::min(static_cast<std::size_t>(i), std::size_t{n_bins_} - 1) + 1;
+}
+
+double Axis::edge(std::size_t i) const noexcept {
+    if (i == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    if (i > n_bins_ + std::size_t{1}) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (i == n_bins_ + std::size_t{1}) {
+        return max_;
+    }
+
+    const auto x = offset_ + static_cast<double>(i - 1) / scale_;
+    return log_ ? std::exp(x) : x;
+}
+
+std::optional<Axis> to_axis(std::string_view spec) noexcept {
+    std::vector<std::string_view> fields;
+    for (std::size_t first = 0; first <= spec.size();) {
+        const auto last = std::min(spec.find(',', first), spec.size());
+        fields.emplace_back(spec.substr(first, last - first));
+        first = last + 1;
+    }
+    if (fields.size() != 3 and not(fields.size() == 4 and fields[3] == "log")) {
+        return std::nullopt;
+    }
+
+    constexpr auto invalid = std::numeric_limits<double>::quiet_NaN();
+    const auto min = utility::to<double>(fields[0], invalid);
+    const auto max = utility::to<double>(fields[1], invalid);
+    const auto n_bins = utility::to<int>(fields[2], 0);
+    const auto log = fields.size() == 4;
+    if (not std::isfinite(min) or not std::isfinite(max) or not(min < max) or n_bins <= 0
+        or (log and not(min > 0.))) {
+        return std::nullopt;
+    }
+
+    return Axis{min, max, static_cast<unsigned>(n_bins), log};
+}
+
+void Histogram2D::merge(const Histogram2D& other) noexcept {
+    std::transform(
+        counts_.begin(), counts_.end(), other.counts_.begin(), counts_.begin(), std::plus{});
+}
+}   // namespace seqmaker
@@ -1,44 +1,161 @@
 #include "mmsi_counter.hpp"
 
 #include "io.hpp"
+#include "mmsi_map.hpp"
+#include "radix_sort.hpp"
 #include "utility.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace seqmaker {
-[[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
-count_mmsi(std::string_view delimiter) {
-    std::unordered_map<ais::mmsi_t, unsigned> hist;
-
-    io::process_input_stream([delimiter, &hist](std::string_view line) {
-        constexpr ais::mmsi_t fallback = 0;
-        const auto mmsi = utility::split_map(
-            line,
-            delimiter,
-            [](std::string_view /* t */, std::string_view mmsi) {
-                return mmsi.empty() ? fallback : utility::to<ais::mmsi_t>(mmsi, fallback);
-            });
-        if (mmsi > 0) {
-            auto it = hist.find(mmsi);
-            if (it == hist.end()) {
-                it = hist.emplace(mmsi, 0U).first;
+namespace {
+    using CountTable = MmsiMap<std::size_t>;
+
+    /*
+     * Counts the positive MMSIs in the second column of each line of the chunk, where columns are
+     * separated as by io::Tokenizer. Only the first two columns of a line are scanned, the
+     * remainder is skipped to the next line break.
+     */
+    void count_chunk(std::string_view chunk,
+                     const std::array<bool, 256>& is_delimiter,   // NOLINT
+                     CountTable& table) {
+        auto is_d = [&is_delimiter](char c) { return is_delimiter[static_cast<unsigned char>(c)]; };
+
+        for (std::size_t pos = 0; pos < chunk.size();) {
+            const auto eol = std::min(chunk.find('\n', pos), chunk.size());
+
+            // skips delimiters (or the column) starting at i
+            auto skip = [&chunk, &is_d, eol](std::size_t i, bool delimiter) {
+                while (i < eol and is_d(chunk[i]) == delimiter) {
+                    i++;
+                }
+                return i;
+            };
+            const auto first = skip(skip(skip(pos, true), false), true);
+            auto last = skip(first, false);
+            if (last == eol and last > first and chunk[last - 1] == '\r') {
+                last--;
             }
-            it->second++;
+            if (first == last) {
+                throw std::invalid_argument("Invalid data format. Could not find enough columns.");
+            }
+
+            constexpr ais::mmsi_t fallback = 0;
+            const auto mmsi = utility::to_integer<ais::mmsi_t>(
+                chunk.substr(first, last - first), fallback, chunk.size() - first);
+            if (mmsi > 0) {
+                table.find_or_insert(mmsi).first++;
+            }
+
+            pos = eol + 1;
+        }
+    }
+
+    [[nodiscard]] std::array<bool, 256> delimiter_table(std::string_view delimiter) noexcept {
+        std::array<bool, 256> is_delimiter{};   // NOLINT
+        for (auto c : delimiter) {
+            is_delimiter[static_cast<unsigned char>(c)] = true;
+        }
+        return is_delimiter;
+    }
+
+    /*
+     * Splits the block into chunks that are counted by n_threads threads, cf. count_chunk.
+     */
+    void count_block(std::string_view block,
+                     const std::array<bool, 256>& is_delimiter,   // NOLINT
+                     std::vector<CountTable>& tables,
+                     unsigned n_threads) {
+        const auto chunks = io::split_block(block, n_threads);
+        utility::parallel_for(chunks.size(), n_threads, [&](unsigned worker, std::size_t i) {
+            count_chunk(chunks[i], is_delimiter, tables[worker]);
+        });
+    }
+
+    /*
+     * Merges the counts of all workers and sorts them as returned by count_mmsi.
+     */
+    [[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
+    merge(const std::vector<CountTable>& tables, unsigned n_threads) {
+        // the counts of all workers are merged by sorting them by MMSI
+        std::vector<std::pair<ais::mmsi_t, std::size_t>> counts;
+        for (const auto& table : tables) {
+            table.for_each(
+                [&counts](ais::mmsi_t mmsi, std::size_t n) { counts.emplace_back(mmsi, n); });
         }
-    });
+        utility::radix_sort(
+            counts, [](const auto& x) { return static_cast<std::uint32_t>(x.first); }, n_threads);
 
-    std::vector<std::pair<ais::mmsi_t, std::size_t>> sorted_counts;
-    sorted_counts.reserve(hist.size());
-    for (auto [mmsi, n] : hist) {
-        sorted_counts.emplace_back(mmsi, n);
+        std::vector<std::pair<ais::mmsi_t, std::size_t>> sorted_counts;
+        for (auto [mmsi, n] : counts) {
+            if (not sorted_counts.empty() and sorted_counts.back().first == mmsi) {
+                sorted_counts.back().second += n;
+            } else {
+                sorted_counts.emplace_back(mmsi, n);
+            }
+        }
+
+        // the radix sort is stable, i.e., MMSIs with a common count stay in ascending order
+        utility::radix_sort(
+            sorted_counts,
+            [](const auto& x) { return std::numeric_limits<std::size_t>::max() - x.second; },
+            n_threads);
+
+        return sorted_counts;
+    }
+}   // namespace
+
+[[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
+count_mmsi_block(std::string_view block, std::string_view delimiter, unsigned n_threads) {
+    n_threads = std::max(n_threads, 1U);
+
+    std::vector<CountTable> tables(n_threads);
+    count_block(block, delimiter_table(delimiter), tables, n_threads);
+    return merge(tables, n_threads);
+}
+
+[[nodiscard]] std::vector<std::pair<ais::mmsi_t, std::size_t>>
+count_mmsi(std::string_view delimiter, unsigned n_threads, std::span<const std::string> files) {
+    n_threads = std::max(n_threads, 1U);
+
+    const auto is_delimiter = delimiter_table(delimiter);
+    std::vector<CountTable> tables(n_threads);
+    if (n_threads > 1 and not files.empty() and files.size() >= n_threads) {
+        // counts do not depend on the order of the lines, hence each file is counted by a worker
+        utility::parallel_for(files.size(), n_threads, [&](unsigned worker, std::size_t i) {
+            const io::detail::FileDescriptor fd{files[i]};
+            io::process_input_blocks(fd.get(), [&](std::string_view block) {
+                count_chunk(block, is_delimiter, tables[worker]);
+            });
+        });
+    } else {
+        auto count_blocks = [&is_delimiter, &tables, n_threads](int fd) {
+            io::process_input_blocks(
+                fd,
+                [&is_delimiter, &tables, n_threads](std::string_view block) {
+                    count_block(block, is_delimiter, tables, n_threads);
+                },
+                n_threads * io::DEFAULT_BLOCK_SIZE);
+        };
+
+        if (files.empty()) {
+            count_blocks(STDIN_FILENO);
+        }
+        for (const auto& file : files) {
+            const io::detail::FileDescriptor fd{file};
+            count_blocks(fd.get());
+        }
     }
-    std::sort(sorted_counts.begin(), sorted_counts.end(), [](auto a, auto b) {
-        return a.second > b.second;
-    });
 
-    return sorted_counts;
+    return merge(tables, n_threads);
 }
 }   // namespace seqmaker
@@ -0,0 +1,153 @@
+#include "pack_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/mman.h>
+
+namespace seqmaker {
+namespace {
+    constexpr std::array<char, 8> MAGIC{'A', 'I', 'S', 'P', 'A', 'C', 'K', '\0'};
+
+    static_assert(std::is_trivially_copyable_v<ais::Point>
+                  and sizeof(ais::Point) == 2 * sizeof(ais::Point::value_type));
+    static_assert(sizeof(PackFile::Entry) == 3 * sizeof(std::uint64_t));
+
+    struct Header {
+        std::array<char, 8> magic;   // NOLINT
+        std::uint32_t version;       // NOLINT
+        std::uint32_t point_size;    // NOLINT
+        std::uint64_t n_mmsis;       // NOLINT
+        std::uint64_t n_points;      // NOLINT
+        std::uint64_t index;         // NOLINT
+        std::uint64_t points;        // NOLINT
+        std::uint64_t size;          // NOLINT
+    };
+
+    /*
+     * The header of a pack file of the current version with the given number of entries.
+     */
+    [[nodiscard]] constexpr Header layout(std::uint64_t n_mmsis, std::uint64_t n_points) noexcept {
+        const auto index = io::align(sizeof(Header));
+        const auto points = io::align(index + n_mmsis * sizeof(PackFile::Entry));
+        return Header{.magic = MAGIC,
+                      .version = PackFile::VERSION,
+                      .point_size = sizeof(ais::Point),
+                      .n_mmsis = n_mmsis,
+                      .n_points = n_points,
+                      .index = index,
+                      .points = points,
+                      .size = points + n_points * sizeof(ais::Point)};
+    }
+
+    [[nodiscard]] std::invalid_argument invalid_pack(const std::filesystem::path& path,
+                                                     std::string_view reason) {
+        return io::invalid_file("pack file", path, reason);
+    }
+}   // namespace
+
+PackFile::PackFile(const std::filesystem::path& path)
+    : fd_(path)
+    , file_(fd_.get(),
+            std::max(io::file_size(fd_.get(), path), std::size_t{1}),
+            PROT_READ,
+            MADV_NORMAL) {
+    if (not file_) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+
+    const auto bytes = file_.view();
+    Header header{};
+    if (io::file_size(fd_.get(), path) < sizeof(header)) {
+        throw invalid_pack(path, "The file is too small.");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (header.magic != MAGIC) {
+        throw invalid_pack(path,
+                           "The file is no pack file or was written with another byte order.");
+    }
+    if (header.version != VERSION) {
+        throw invalid_pack(path,
+                           "The pack file has version " + std::to_string(header.version)
+                               + " instead of " + std::to_string(VERSION) + '.');
+    }
+
+    const auto expected = layout(header.n_mmsis, header.n_points);
+    if (header.point_size != expected.point_size or header.index != expected.index
+        or header.points != expected.points or header.size != expected.size
+        or header.size != bytes.size()) {
+        throw invalid_pack(path, "The layout of the file does not match its header.");
+    }
+
+    index_ = {reinterpret_cast<const Entry*>(file_.data() + header.index),   // NOLINT
+              header.n_mmsis};
+
+    // the points of all entries must lie within the file
+    const auto is_valid = [&header](const Entry& entry) {
+        return entry.offset >= header.points and entry.offset % sizeof(ais::Point) == 0
+               and entry.n_points <= (header.size - entry.offset) / sizeof(ais::Point);
+    };
+    if (not std::all_of(index_.begin(), index_.end(), is_valid)) {
+        throw invalid_pack(path, "The index is corrupted.");
+    }
+
+    // MMSIs are found by a binary search and their points are stored in order of the index
+    const auto is_unordered = [](const Entry& a, const Entry& b) {
+        return a.mmsi >= b.mmsi or b.offset < a.offset
+               or b.offset - a.offset < a.n_points * sizeof(ais::Point);
+    };
+    if (std::adjacent_find(index_.begin(), index_.end(), is_unordered) != index_.end()) {
+        throw invalid_pack(path, "The entries of the index are unordered or overlap.");
+    }
+}
+
+std::optional<std::span<const ais::Point>> PackFile::find(ais::mmsi_t mmsi) const {
+    const auto it = std::lower_bound(index_.begin(), index_.end(), mmsi, [](const auto& e, auto m) {
+        return e.mmsi < m;
+    });
+    if (it == index_.end() or it->mmsi != mmsi) {
+        return std::nullopt;
+    }
+    return points(static_cast<std::size_t>(it - index_.begin()));
+}
+
+void PackFile::write(const std::filesystem::path& path, const Sequences& seqs) {
+    std::vector<Entry> index;
+    index.reserve(seqs.size());
+    for (const auto& [mmsi, points] : seqs) {
+        index.emplace_back(
+            Entry{.mmsi = mmsi, .padding = 0, .offset = 0, .n_points = points.size()});
+    }
+    std::sort(index.begin(), index.end(), [](auto a, auto b) { return a.mmsi < b.mmsi; });
+
+    std::uint64_t n_points = 0;
+    for (const auto& entry : index) {
+        n_points += entry.n_points;
+    }
+    const auto header = layout(index.size(), n_points);
+
+    auto offset = header.points;
+    for (auto& entry : index) {
+        entry.offset = offset;
+        offset += entry.n_points * sizeof(ais::Point);
+    }
+
+    io::BinaryWriter out{path};
+    out.put(&header, sizeof(header));
+    out.pad(header.index);
+    out.put(index.data(), index.size() * sizeof(Entry));
+    out.pad(header.points);
+    for (const auto& entry : index) {
+        const auto& points = seqs.at(entry.mmsi);
+        out.put(points.data(), points.size() * sizeof(ais::Point));
+    }
+    out.flush();
+}
+}   // namespace seqmaker
@@ -0,0 +1,298 @@
+#include "parse.hpp"
+
+#include "io.hpp"
+#include "stats.hpp"
+#include "tokenizer.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace seqmaker {
+namespace {
+    [[nodiscard]] std::optional<std::pair<ais::mmsi_t, ais::Position>>
+    parse_ais_columns(std::string_view t_str,
+                      std::string_view mmsi_str,
+                      std::string_view slot_str,
+                      std::string_view lat_str,
+                      std::string_view lon_str) {
+        auto any_empty = [](auto... x) { return (x.empty() || ...); };
+        if (any_empty(t_str, mmsi_str, slot_str, lat_str, lon_str)) {
+            stats::add(stats::Counter::rows_rejected_missing_column, 1);
+            throw std::invalid_argument("Invalid data format. At least one column is empty.");
+        }
+
+        constexpr auto pos_fallback = std::numeric_limits<ais::Point::value_type>::max();
+
+        const auto t = utility::time_recorded<ais::time_t>(t_str, slot_str);
+        const auto mmsi = utility::to<ais::mmsi_t>(mmsi_str, 0);
+        const auto lat = utility::to<ais::Point::value_type>(lat_str, pos_fallback);
+        const auto lon = utility::to<ais::Point::value_type>(lon_str, pos_fallback);
+
+        auto valid_pos = [](auto lat, auto lon) {
+            constexpr auto MAX_LAT = ais::Point::MAX_LATITUDE;
+            constexpr auto MAX_LON = ais::Point::MAX_LONGITUDE;
+            constexpr auto MIN_LAT = ais::Point::MIN_LATITUDE;
+            constexpr auto MIN_LON = ais::Point::MIN_LONGITUDE;
+            static_assert(MAX_LAT < pos_fallback);
+            static_assert(MAX_LON < pos_fallback);
+            return MIN_LAT <= lat and lat <= MAX_LAT and MIN_LON <= lon and lon <= MAX_LON;
+        };
+
+        const auto is_valid = ais::is_valid_mmsi(mmsi) and t and valid_pos(lat, lon);
+        return is_valid ? std::optional{std::make_pair(
+                   mmsi,
+                   ais::Position{.t = *t, .x = ais::Point{.latitude = lat, .longitude = lon}})}
+                        : std::nullopt;
+    }
+
+    constexpr std::size_t N_AIS_COLUMNS = 5;
+
+    /*
+     * Decoded columns of a batch of lines, which are reused across batches.
+     */
+    struct Columns {
+        std::vector<ais::time_t> recv;
+        std::vector<ais::mmsi_t> mmsi;
+        std::vector<signed> slot;
+        std::vector<ais::Point::value_type> lat;
+        std::vector<ais::Point::value_type> lon;
+    };
+
+    /*
+     * Decodes a column of a batch of lines, where all tokens are views into lines.
+     */
+    template <typename T>
+    void decode_column(std::string_view lines,
+                       std::span<const std::string_view> tokens,
+                       std::size_t column,
+                       T fallback,
+                       std::vector<T>& values) {
+        values.resize(tokens.size() / N_AIS_COLUMNS);
+        for (std::size_t i = 0; i < values.size(); i++) {
+            const auto token = tokens[i * N_AIS_COLUMNS + column];
+            const auto offset = static_cast<std::size_t>(token.data() - lines.data());
+            const auto n_readable = lines.size() - offset;
+            values[i] = utility::to_integer<T>(token, fallback, n_readable);
+        }
+    }
+
+    /*
+     * Decodes the columns of a batch of lines column by column and appends the valid positions to
+     * the batch, cf. parse_ais_columns.
+     */
+    void decode_rows(std::string_view lines,
+                     std::span<const std::string_view> tokens,
+                     Columns& columns,
+                     TrajectoryStore::Batch& batch) {
+        constexpr signed SLOT_MAX = 59;
+        constexpr auto POS_FALLBACK = std::numeric_limits<ais::Point::value_type>::max();
+        decode_column(lines, tokens, 0, ais::time_t{0}, columns.recv);
+        decode_column(lines, tokens, 1, ais::mmsi_t{0}, columns.mmsi);
+        decode_column(lines, tokens, 2, SLOT_MAX + 1, columns.slot);
+        decode_column(lines, tokens, 3, POS_FALLBACK, columns.lat);
+        decode_column(lines, tokens, 4, POS_FALLBACK, columns.lon);
+
+        // every line is written and invalid ones are overwritten by their successor, where
+        // rejected lines are counted by the first reason of their rejection, cf. stats::Counter
+        const auto count = stats::enabled();
+        std::uint64_t n_time = 0;
+        std::uint64_t n_mmsi = 0;
+        std::uint64_t n_slot = 0;
+        std::uint64_t n_position = 0;
+        const auto n = columns.recv.size();
+        auto k = batch.size();
+        batch.resize(k + n);
+        for (std::size_t i = 0; i < n; i++) {
+            const auto recv = columns.recv[i];
+            const auto slot = columns.slot[i];
+            const auto mmsi = columns.mmsi[i];
+            const auto lat = columns.lat[i];
+            const auto lon = columns.lon[i];
+
+            const auto valid_time = recv != 0;
+            const auto valid_mmsi = ais::is_valid_mmsi(mmsi);
+            const auto valid_slot = slot <= SLOT_MAX;
+            const auto valid_position = ais::Point::MIN_LATITUDE <= lat
+                                        and lat <= ais::Point::MAX_LATITUDE
+                                        and ais::Point::MIN_LONGITUDE <= lon
+                                        and lon <= ais::Point::MAX_LONGITUDE;
+            const auto is_valid = valid_time and valid_mmsi and valid_slot and valid_position;
+
+            if (count and not is_valid) {
+                if (not valid_time) {
+                    n_time++;
+                } else if (not valid_mmsi) {
+                    n_mmsi++;
+                } else if (not valid_slot) {
+                    n_slot++;
+                } else {
+                    n_position++;
+                }
+            }
+
+            batch[k] = std::make_pair(
+                mmsi,
+                ais::Position{.t = utility::slot_corrected(recv, slot),
+                              .x = ais::Point{.latitude = lat, .longitude = lon}});
+            k += is_valid ? 1 : 0;
+        }
+        batch.resize(k);
+
+        stats::add(stats::Counter::rows_parsed, n);
+        stats::add(stats::Counter::rows_rejected_time, n_time);
+        stats::add(stats::Counter::rows_rejected_mmsi, n_mmsi);
+        stats::add(stats::Counter::rows_rejected_slot, n_slot);
+        stats::add(stats::Counter::rows_rejected_position, n_position);
+    }
+}   // namespace
+
+[[nodiscard]] std::optional<std::pair<ais::mmsi_t, ais::Position>>
+parse_ais_line(std::string_view line, std::string_view delimiter) {
+    return utility::split_map(line, delimiter, parse_ais_columns);
+}
+
+[[nodiscard]] TrajectoryStore::Batch parse_ais_lines(std::string_view lines,
+                                                     std::string_view delimiter) {
+    TrajectoryStore::Batch batch;
+    Columns columns;
+    io::Tokenizer{delimiter}.for_each_batch(
+        lines, N_AIS_COLUMNS, [lines, &batch, &columns](std::span<const std::string_view> tokens) {
+            decode_rows(lines, tokens, columns, batch);
+        });
+
+    return batch;
+}
+
+[[nodiscard]] std::vector<TrajectoryStore::Batch>
+parse_ais_block(std::string_view block, std::string_view delimiter, unsigned n_threads) {
+    if (n_threads <= 1) {
+        std::vector<TrajectoryStore::Batch> batches;
+        batches.emplace_back(parse_ais_lines(block, delimiter));
+        return batches;
+    }
+
+    // parse newline-aligned chunks into thread-local batches
+    const auto chunks = io::split_block(block, n_threads);
+    std::vector<TrajectoryStore::Batch> batches(chunks.size());
+    utility::parallel_for(chunks.size(), n_threads, [&](unsigned /* worker */, std::size_t i) {
+        batches[i] = parse_ais_lines(chunks[i], delimiter);
+    });
+
+    return batches;
+}
+
+void parse_ais_input(std::span<const std::string> files,
+                     std::string_view delimiter,
+                     unsigned n_threads,
+                     const std::function<void(const TrajectoryStore::Batch&)>& f) {
+    n_threads = std::max(n_threads, 1U);
+
+    auto read_blocks = [delimiter, n_threads, &f](int fd) {
+        io::process_input_blocks(
+            fd,
+            [delimiter, n_threads, &f](std::string_view block) {
+                const auto batches = [&] {
+                    const stats::Scope scope{stats::Stage::parse};
+                    return parse_ais_block(block, delimiter, n_threads);
+                }();
+                for (const auto& batch : batches) {
+                    f(batch);
+                }
+            },
+            n_threads * io::DEFAULT_BLOCK_SIZE);
+    };
+
+    if (files.empty()) {
+        read_blocks(STDIN_FILENO);
+        return;
+    }
+
+    if (n_threads == 1 or files.size() < n_threads) {
+        for (const auto& file : files) {
+            const io::detail::FileDescriptor fd{file};
+            read_blocks(fd.get());
+        }
+        return;
+    }
+
+    // files are handed out in order, hence the file whose turn it is has always been taken by a
+    // worker. This worker passes its batches on as they are parsed, while the other workers queue
+    // at most MAX_PENDING batches each and wait for their turn, such that memory does not scale
+    // with the size of the files and the staged input is bounded by f (e.g., cf. --mem-limit)
+    constexpr std::size_t MAX_PENDING = 2;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t turn = 0;
+    bool failed = false;
+    utility::parallel_for(files.size(), n_threads, [&](unsigned /* worker */, std::size_t i) {
+        std::vector<TrajectoryStore::Batch> pending;
+        auto aborted = false;
+
+        // whether it is the turn of this file, where the pending batches are passed on first
+        auto wait_for_turn = [&](bool done) {
+            {
+                std::unique_lock lock{mutex};
+                cv.wait(lock, [&] {
+                    return turn == i or failed or (not done and pending.size() < MAX_PENDING);
+                });
+
+                // the error of the failed file is passed on by its own worker
+                aborted = failed;
+                if (aborted or turn != i) {
+                    return false;
+                }
+            }
+
+            for (const auto& batch : pending) {
+                f(batch);
+            }
+            pending.clear();
+            return true;
+        };
+
+        try {
+            const io::detail::FileDescriptor fd{files[i]};
+            io::process_input_blocks(fd.get(), [&](std::string_view block) {
+                if (aborted) {
+                    return;
+                }
+
+                auto batch = [&] {
+                    const stats::Scope scope{stats::Stage::parse, stats::Clock::thread};
+                    return parse_ais_lines(block, delimiter);
+                }();
+                if (wait_for_turn(false)) {
+                    f(batch);
+                } else if (not aborted) {
+                    pending.emplace_back(std::move(batch));
+                }
+            });
+            wait_for_turn(true);
+        } catch (...) {
+            {
+                const std::lock_guard lock{mutex};
+                failed = true;
+            }
+            cv.notify_all();
+            throw;
+        }
+
+        if (not aborted) {
+            {
+                const std::lock_guard lock{mutex};
+                turn++;
+            }
+            cv.notify_all();
+        }
+    });
+}
+}   // namespace seqmaker
@@ -2,14 +2,24 @@
 
 #include "seq.hpp"
 
+#include <iterator>
+#include <utility>
+
 namespace seqmaker {
-void SequenceCounter::process(ais::mmsi_t mmsi, const ais::Trajectory& trajectory) noexcept {
-    drop_rates_.emplace(mmsi, drop_rate(trajectory, split_args_));
+void SequenceCounter::process(unsigned worker,
+                              ais::mmsi_t mmsi,
+                              ais::TrajectoryView trajectory) noexcept {
+    drop_rates_[worker].emplace(mmsi, drop_rate(trajectory, split_args_, buffers_[worker]));
 }
 
 [[nodiscard]] std::unordered_map<ais::mmsi_t, double>
-SequenceCounter::run(bool apply_low_pass_filter) noexcept {
+SequenceCounter::run(bool apply_low_pass_filter) {
     Sequencer::run(apply_low_pass_filter);
-    return drop_rates_;
+
+    auto& drop_rates = drop_rates_.front();
+    for (auto it = std::next(drop_rates_.begin()); it != drop_rates_.end(); it++) {
+        drop_rates.merge(*it);
+    }
+    return std::move(drop_rates);
 }
 }   // namespace seqmaker
\ No newline at end of file
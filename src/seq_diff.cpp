@@ -1,39 +1,159 @@
 #include "seq_diff.hpp"
 
-#include "utility.hpp"
-
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <utility>
+#include <vector>
 
 namespace seqmaker {
-void SequenceDiff::process(ais::mmsi_t /* mmsi */, const ais::Trajectory& trajectory) noexcept {
-    if (trajectory.size() > stride_) {
-        std::vector<std::pair<ais::time_t, ais::Point::value_type>> diff;
-        diff.reserve(trajectory.size() - stride_);
-        utility::adjacent_diff(
-            trajectory.begin(),
-            trajectory.end(),
-            std::back_inserter(diff),
-            [](auto pos1, auto pos2) {
-                const auto dt = pos2.t - pos1.t;
-                const auto dx_nm = pos2.x.dist_nm(pos1.x);
+void SequenceDiff::hand_off(const std::vector<std::vector<Diff>>& diffs) {
+    for (std::size_t k = 0; k < strides_.size(); k++) {
+        auto& chunk = chunks_[k];
+        chunk.insert(chunk.end(), diffs[k].begin(), diffs[k].end());
+        if (chunk.size() >= SINK_CHUNK_SIZE) {
+            sink_(k, chunk);
+            chunk.clear();
+        }
+    }
+}
 
-                constexpr double AIS_SCALE = 10000.;
-                const auto dx_ais = std::round(dx_nm * AIS_SCALE);
+void SequenceDiff::flush() {
+    for (std::size_t k = 0; k < strides_.size(); k++) {
+        if (not chunks_[k].empty()) {
+            sink_(k, chunks_[k]);
+            chunks_[k].clear();
+        }
+    }
+}
+
+void SequenceDiff::init(std::size_t n_trajectories, unsigned n_workers) noexcept {
+    // histograms and chunks persist across rounds, while the handoff starts over
+    assert(pending_.empty());   // NOLINT
+    done_.assign(n_trajectories, false);
+    next_ = 0;
+
+    if (workers_.size() != n_workers) {
+        workers_.resize(n_workers);
+        for (auto& worker : workers_) {
+            worker.diffs.resize(strides_.size());
+            if (hist_) {
+                worker.hists.assign(strides_.size(), *hist_);
+            }
+        }
+    }
+    chunks_.resize(strides_.size());
+}
+
+void SequenceDiff::complete(unsigned worker, std::size_t i) noexcept {
+    if (not sink_) {
+        return;
+    }
 
-                return std::make_pair(dt,
-                                      static_cast<typename decltype(pos1.x)::value_type>(dx_ais));
-            },
-            stride_);
+    auto& diffs = workers_[worker].diffs;
+    std::size_t n = 0;
+    for (const auto& diff : diffs) {
+        n += diff.size();
+    }
+
+    std::unique_lock lock{handoff_->mutex};
+    handoff_->handed_off.wait(lock, [this, i, n] {
+        return i == next_ or n == 0 or n_pending_ + n <= MAX_PENDING;
+    });
+    if (i == next_) {
+        hand_off(diffs);
+        for (next_++; next_ < done_.size() and done_[next_]; next_++) {
+            if (auto it = pending_.find(next_); it != pending_.end()) {
+                hand_off(it->second);
+                for (const auto& diff : it->second) {
+                    n_pending_ -= diff.size();
+                }
+                pending_.erase(it);
+            }
+        }
+        handoff_->handed_off.notify_all();
+    } else {
+        done_[i] = true;
+        if (n > 0) {
+            // copied such that the worker keeps its buffers
+            pending_.emplace(i, diffs);
+            n_pending_ += n;
+        }
+    }
+    lock.unlock();
 
-        diffs_.insert(diffs_.end(), diff.begin(), diff.end());
+    for (auto& diff : diffs) {
+        diff.clear();
     }
 }
 
-std::vector<std::pair<ais::time_t, ais::Point::value_type>>
-SequenceDiff::run(unsigned stride) noexcept {
-    stride_ = stride;
+void SequenceDiff::process(unsigned worker,
+                           ais::mmsi_t /* mmsi */,
+                           ais::TrajectoryView trajectory) noexcept {
+    auto& w = workers_[worker];
+    for (std::size_t k = 0; k < strides_.size(); k++) {
+        const auto stride = strides_[k];
+        if (trajectory.size() <= stride) {
+            continue;
+        }
+
+        w.dx.resize(trajectory.size() - stride);
+        ais::with_metric(split_args_.metric, [&](auto m) {
+            using M = decltype(m);
+            ais::adjacent_dist<M>(trajectory, w.dx, stride);
+
+            auto& diff = w.diffs[k];
+            for (std::size_t i = 0; i < w.dx.size(); i++) {
+                const auto dt = trajectory[i + stride].t - trajectory[i].t;
+
+                constexpr double AIS_SCALE = 10000.;
+                const auto dx_ais = std::round(M::to_nm(w.dx[i]) * AIS_SCALE);
+
+                if (hist_) {
+                    w.hists[k].fill(dt, dx_ais);
+                } else {
+                    diff.emplace_back(dt, static_cast<ais::Point::value_type>(dx_ais));
+                }
+            }
+        });
+    }
+}
+
+std::vector<SequenceDiff::Diff> SequenceDiff::run(unsigned stride) {
+    std::vector<Diff> diffs;
+    run({stride}, [&diffs](std::size_t /* k */, std::span<const Diff> chunk) {
+        diffs.insert(diffs.end(), chunk.begin(), chunk.end());
+    });
+    return diffs;
+}
+
+void SequenceDiff::run(std::vector<unsigned> strides, Sink sink) {
+    strides_ = std::move(strides);
+    sink_ = std::move(sink);
+    in_mmsi_order_ = true;
     Sequencer::run(false);
-    return diffs_;
+
+    flush();
+    sink_ = nullptr;
+    in_mmsi_order_ = false;
+    workers_.clear();
+    chunks_.clear();
+}
+
+std::vector<Histogram2D> SequenceDiff::run(std::vector<unsigned> strides,
+                                           const Histogram2D& hist) {
+    strides_ = std::move(strides);
+    hist_ = hist;
+    Sequencer::run(false);
+
+    std::vector<Histogram2D> hists(strides_.size(), hist);
+    for (const auto& worker : workers_) {
+        for (std::size_t k = 0; k < strides_.size(); k++) {
+            hists[k].merge(worker.hists[k]);
+        }
+    }
+    hist_.reset();
+    workers_.clear();
+    return hists;
 }
 }   // namespace seqmaker
@@ -1,21 +1,55 @@
 #include "seq_maker.hpp"
 
 #include "seq.hpp"
+#include "stats.hpp"
+
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace seqmaker {
-void SequenceMaker::init(std::size_t n_trajectories) noexcept {
-    seqs_.reserve(n_trajectories);
+void SequenceMaker::init(std::size_t n_trajectories, unsigned n_workers) noexcept {
+    seqs_.resize(n_workers);
+    buffers_.resize(n_workers);
+    stripped_seqs_.resize(n_workers);
+    seqs_.front().reserve(n_trajectories);
 }
 
-void SequenceMaker::process(ais::mmsi_t mmsi, const ais::Trajectory& trajectory) noexcept {
-    if (auto stripped_seq = split(trajectory, split_args_); not stripped_seq.empty()) {
-        seqs_.emplace(mmsi, stripped_seq);
+void SequenceMaker::process(unsigned worker,
+                            ais::mmsi_t mmsi,
+                            ais::TrajectoryView trajectory) noexcept {
+    auto& stripped_seq = stripped_seqs_[worker];
+    stripped_seq.clear();
+    {
+        const stats::Scope scope{stats::Stage::split, stats::Clock::thread};
+        split(trajectory, split_args_, buffers_[worker], std::back_inserter(stripped_seq));
+    }
+    if (stripped_seq.empty()) {
+        return;
+    }
+
+    if (sink_) {
+        sink_(mmsi, stripped_seq);
+    } else {
+        // the buffer keeps its capacity and the kept copy is allocated once at its final size
+        seqs_[worker].emplace(mmsi, stripped_seq);
     }
 }
 
 std::unordered_map<ais::mmsi_t, std::vector<ais::Point>>
-SequenceMaker::run(bool apply_low_pass_filter) noexcept {
+SequenceMaker::run(bool apply_low_pass_filter) {
+    Sequencer::run(apply_low_pass_filter);
+
+    auto& seqs = seqs_.front();
+    for (auto it = std::next(seqs_.begin()); it != seqs_.end(); it++) {
+        seqs.merge(*it);
+    }
+    return std::move(seqs);
+}
+
+void SequenceMaker::run(bool apply_low_pass_filter, Sink sink) {
+    sink_ = std::move(sink);
     Sequencer::run(apply_low_pass_filter);
-    return seqs_;
+    sink_ = nullptr;
 }
 }   // namespace seqmaker
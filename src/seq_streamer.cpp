@@ -0,0 +1,142 @@
+#include "seq_streamer.hpp"
+
+#include "parse.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace seqmaker {
+SequenceStreamer::SequenceStreamer(split_args split_args, stream_args stream_args, Sink sink)
+    : split_args_(split_args)
+    , stream_args_(stream_args)
+    , sink_(std::move(sink)) {
+}
+
+ais::time_t SequenceStreamer::watermark() const noexcept {
+    const auto window = stream_args_.reorder_window;
+    return t_max_ > window ? t_max_ - window : 0;
+}
+
+void SequenceStreamer::feed(ais::mmsi_t mmsi, Vessel& vessel, ais::Position pos) {
+    if (vessel.has_last and pos.t == vessel.last.t) {
+        stats::add(stats::Counter::duplicates_removed, 1);
+        return;
+    }
+
+    auto emit = [this, mmsi](std::span<const ais::Point> seq) { sink_(mmsi, seq); };
+    if (not stream_args_.apply_low_pass_filter) {
+        vessel.splitter.push(pos, emit);
+    } else if (vessel.has_last) {
+        // a position passes the filter if it is close to its predecessor or successor
+        const auto valid = ais::dist(split_args_.metric, vessel.last.x, pos.x)
+                           <= ais::from_nm(split_args_.metric, split_args_.ds_max);
+        if (vessel.last_valid or valid) {
+            vessel.splitter.push(vessel.last, emit);
+        } else {
+            stats::add(stats::Counter::points_filtered, 1);
+        }
+        vessel.last_valid = valid;
+    }
+
+    vessel.last = pos;
+    vessel.has_last = true;
+}
+
+void SequenceStreamer::release(ais::mmsi_t mmsi, Vessel& vessel, ais::time_t watermark) {
+    auto& pending = vessel.pending;
+    const auto last = std::upper_bound(
+        pending.begin(), pending.end(), watermark, [](auto t, auto pos) { return t < pos.t; });
+    for (auto it = pending.begin(); it != last; it++) {
+        feed(mmsi, vessel, *it);
+    }
+    pending.erase(pending.begin(), last);
+}
+
+void SequenceStreamer::close(ais::mmsi_t mmsi, Vessel& vessel) {
+    release(mmsi, vessel, std::numeric_limits<ais::time_t>::max());
+
+    if (stream_args_.apply_low_pass_filter and vessel.has_last) {
+        if (vessel.last_valid) {
+            vessel.splitter.push(vessel.last, [this, mmsi](auto seq) { sink_(mmsi, seq); });
+        } else {
+            stats::add(stats::Counter::points_filtered, 1);
+        }
+    }
+}
+
+void SequenceStreamer::evict() {
+    const auto t = watermark();
+    for (auto it = vessels_.begin(); it != vessels_.end();) {
+        auto& [mmsi, vessel] = *it;
+        release(mmsi, vessel, t);
+
+        if (vessel.t_max < t and t - vessel.t_max > split_args_.dt_max) {
+            close(mmsi, vessel);
+            it = vessels_.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    next_eviction_ = t_max_ + std::max(split_args_.dt_max, 1U);
+}
+
+void SequenceStreamer::push(ais::mmsi_t mmsi, ais::Position pos) {
+    t_max_ = std::max(t_max_, pos.t);
+
+    auto& vessel = vessels_.try_emplace(mmsi, split_args_).first->second;
+    if (vessel.has_last and pos.t <= vessel.last.t) {
+        // positions with the time of the last passed position are dropped as duplicates
+        if (pos.t < vessel.last.t) {
+            n_dropped_++;
+            stats::add(stats::Counter::positions_dropped, 1);
+        } else {
+            stats::add(stats::Counter::duplicates_removed, 1);
+        }
+        return;
+    }
+    vessel.t_max = std::max(vessel.t_max, pos.t);
+
+    const auto t = watermark();
+    if (vessel.pending.empty() and pos.t <= t) {
+        feed(mmsi, vessel, pos);
+    } else {
+        auto& pending = vessel.pending;
+        pending.insert(std::upper_bound(pending.begin(),
+                                        pending.end(),
+                                        pos,
+                                        [](auto a, auto b) { return a.t < b.t; }),
+                       pos);
+        release(mmsi, vessel, t);
+    }
+
+    if (t_max_ >= next_eviction_) {
+        evict();
+    }
+}
+
+void SequenceStreamer::finish() {
+    for (auto& [mmsi, vessel] : vessels_) {
+        close(mmsi, vessel);
+    }
+    vessels_.clear();
+}
+
+void SequenceStreamer::run(std::string_view delimiter,
+                           unsigned n_threads,
+                           std::span<const std::string> files) {
+    const stats::Scope scope{stats::Stage::input};
+    parse_ais_input(files, delimiter, n_threads, [this](const TrajectoryStore::Batch& batch) {
+        // batches are passed on by one thread at a time, though not necessarily the same one
+        const stats::Scope process{stats::Stage::process, stats::Clock::thread};
+        for (auto [mmsi, pos] : batch) {
+            push(mmsi, pos);
+        }
+    });
+
+    const stats::Scope process{stats::Stage::process, stats::Clock::thread};
+    finish();
+}
+}   // namespace seqmaker
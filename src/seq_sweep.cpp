@@ -0,0 +1,192 @@
+#include "seq_sweep.hpp"
+
+#include "stats.hpp"
+#include "utility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace seqmaker {
+namespace {
+    [[nodiscard]] std::invalid_argument invalid_grid(std::string_view option,
+                                                     std::string_view requirement) {
+        return std::invalid_argument("Invalid sweep. Value of " + std::string{option}
+                                     + " has to be " + std::string{requirement} + '.');
+    }
+
+    [[nodiscard]] unsigned to_positive_unsigned(std::string_view option, std::string_view value) {
+        const auto x = utility::to<int>(value, 0);
+        if (x <= 0) {
+            throw invalid_grid(option, "non-zero and positive");
+        }
+        return static_cast<unsigned>(x);
+    }
+
+    [[nodiscard]] double to_non_negative(std::string_view option,
+                                         std::string_view value,
+                                         bool positive) {
+        const auto x = utility::to<double>(value, -1.);
+        if (positive and not(x > 0.)) {
+            throw invalid_grid(option, "non-zero and positive");
+        }
+        if (not(x >= 0.)) {
+            throw invalid_grid(option, "zero or positive");
+        }
+        return x;
+    }
+
+    [[nodiscard]] std::vector<std::string_view> split_words(std::string_view str,
+                                                            std::string_view separators) {
+        std::vector<std::string_view> words;
+        for (auto first = str.find_first_not_of(separators); first != std::string_view::npos;) {
+            const auto last = std::min(str.find_first_of(separators, first), str.size());
+            words.emplace_back(str.substr(first, last - first));
+            first = str.find_first_not_of(separators, last);
+        }
+        return words;
+    }
+}   // namespace
+
+std::vector<split_args> expand_grid(std::string_view grid, const split_args& defaults) {
+    using Setter = std::function<void(split_args&, std::string_view)>;
+    const std::array<std::pair<std::string_view, Setter>, 5> setters{{
+        {"-N", [](auto& args, auto x) { args.seq_length = to_positive_unsigned("-N", x); }},
+        {"-t", [](auto& args, auto x) { args.dt_max = to_positive_unsigned("-t", x); }},
+        {"-s", [](auto& args, auto x) { args.ds_max = to_non_negative("-s", x, true); }},
+        {"-i", [](auto& args, auto x) { args.dti = to_positive_unsigned("-i", x); }},
+        {"-v", [](auto& args, auto x) { args.v_min = to_non_negative("-v", x, false); }},
+    }};
+
+    const auto words = split_words(grid, " \t\r");
+    if (words.size() % 2 != 0) {
+        throw std::invalid_argument("Invalid sweep. Each option needs a list of values.");
+    }
+
+    std::vector<split_args> configs{defaults};
+    std::vector<std::string_view> seen;
+    for (std::size_t i = 0; i < words.size(); i += 2) {
+        const auto option = words[i];
+        const auto setter = std::find_if(
+            setters.begin(), setters.end(), [option](const auto& s) { return s.first == option; });
+        if (setter == setters.end()) {
+            throw std::invalid_argument("Invalid sweep. Unknown option \"" + std::string{option}
+                                        + "\".");
+        }
+        if (std::find(seen.begin(), seen.end(), option) != seen.end()) {
+            throw std::invalid_argument("Invalid sweep. Option " + std::string{option}
+                                        + " is given twice.");
+        }
+        seen.emplace_back(option);
+
+        // the values of later options vary fastest
+        std::vector<split_args> expanded;
+        for (const auto& config : configs) {
+            for (auto value : split_words(words[i + 1], ",")) {
+                auto& args = expanded.emplace_back(config);
+                setter->second(args, value);
+            }
+        }
+        configs = std::move(expanded);
+    }
+
+    return configs;
+}
+
+SequenceSweep::SequenceSweep(std::vector<split_args> configs, input_args input_args)
+    : Sequencer(split_args{.seq_length = 0,
+                           .dt_max = 1,
+                           .dti = 0,
+                           .ds_max = 0.,
+                           .v_min = 0.,
+                           .metric = ais::Metric::equirectangular},
+                input_args)
+    , configs_(std::move(configs)) {
+}
+
+void SequenceSweep::init(std::size_t /* n_trajectories */, unsigned n_workers) noexcept {
+    workers_.resize(n_workers);
+    for (auto& worker : workers_) {
+        worker.results.resize(configs_.size());
+    }
+}
+
+void SequenceSweep::process(unsigned worker,
+                            ais::mmsi_t mmsi,
+                            ais::TrajectoryView trajectory) noexcept {
+    auto& w = workers_[worker];
+    for (std::size_t k = 0; k < configs_.size(); k++) {
+        const auto& args = configs_[k];
+
+        // the filter depends on the configuration and is applied to a copy of the trajectory
+        auto filtered = trajectory;
+        if (apply_low_pass_filter_) {
+            w.filtered.assign(trajectory.begin(), trajectory.end());
+            w.filtered.resize(low_pass_filter(w.filtered, args));
+            stats::add(stats::Counter::points_filtered, trajectory.size() - w.filtered.size());
+            filtered = w.filtered;
+        }
+
+        if (not spans_sequence(filtered, args)) {
+            continue;
+        }
+
+        auto& result = w.results[k];
+        const auto rate = drop_rate(filtered, args, w.buffers);
+        result.drop_rates.emplace(mmsi, rate);
+        result.n_dropped += rate * static_cast<double>(filtered.size());
+        result.n_positions += filtered.size();
+
+        w.seqs.clear();
+        {
+            const stats::Scope scope{stats::Stage::split, stats::Clock::thread};
+            split(filtered, args, w.buffers, std::back_inserter(w.seqs));
+        }
+        result.n_sequences += w.seqs.size() / (args.seq_length + 1);
+        if (count_only_ or w.seqs.empty()) {
+            continue;
+        }
+        if (sink_) {
+            sink_(k, mmsi, w.seqs);
+        } else {
+            result.seqs.emplace(mmsi, w.seqs);
+        }
+    }
+}
+
+std::vector<SequenceSweep::Result> SequenceSweep::run(bool apply_low_pass_filter,
+                                                      bool count_only) {
+    apply_low_pass_filter_ = apply_low_pass_filter;
+    count_only_ = count_only;
+
+    // trajectories are filtered per configuration
+    Sequencer::run(false);
+
+    std::vector<Result> results(configs_.size());
+    for (auto& worker : workers_) {
+        for (std::size_t k = 0; k < configs_.size(); k++) {
+            auto& result = results[k];
+            auto& partial = worker.results[k];
+            result.seqs.merge(partial.seqs);
+            result.drop_rates.merge(partial.drop_rates);
+            result.n_sequences += partial.n_sequences;
+            result.n_dropped += partial.n_dropped;
+            result.n_positions += partial.n_positions;
+        }
+    }
+    workers_.clear();
+
+    return results;
+}
+
+std::vector<SequenceSweep::Result> SequenceSweep::run(bool apply_low_pass_filter, Sink sink) {
+    sink_ = std::move(sink);
+    auto results = run(apply_low_pass_filter, false);
+    sink_ = nullptr;
+    return results;
+}
+}   // namespace seqmaker
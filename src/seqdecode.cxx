@@ -0,0 +1,99 @@
+#include "argparse.hpp"
+#include "codec.hpp"
+#include "io.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+static constexpr auto USAGE = R"(seqdecode
+
+    Decodes packed output of seqmaker or seqdiff (cf. --format packed) into the raw binary format
+    of the .bin files, i.e., the concatenated rows of two 32 bit integers each.
+
+    The packed data are read from standard input or from the file given by -i.
+
+    Example:
+        $ ./seqdecode -i "out/211234560.pbin" -f "211234560.bin"
+        Above command decodes the packed sequences of the MMSI 211234560 and writes them in the
+        format of the raw output of seqmaker to the file "211234560.bin".
+
+    Options:
+        -h                Prints this message.
+        -i [file]         The packed input file (default: standard input).
+        -f [file]         The name of the output file for the binary data.)";
+
+[[nodiscard]] auto strip_quotes(std::string str) noexcept {
+    if (auto n = str.size(); n > 2 and str.starts_with('\"') and str.ends_with('\"')) {
+        str = str.erase(0, 1);
+        str = str.erase(n - 2, n - 1);
+    }
+    return str;
+}
+
+[[nodiscard]] std::vector<std::uint32_t> decode_stream() {
+    std::vector<char> bytes;
+    seqmaker::io::process_input_blocks(STDIN_FILENO, [&bytes](std::string_view block) {
+        bytes.insert(bytes.end(), block.begin(), block.end());
+    });
+    return seqmaker::codec::decode(bytes);
+}
+
+int main(int argc, const char** argv) {
+    using namespace seqmaker;
+
+    argparse::Argparse args{argc, argv};
+    if (auto zero_args = (args.n_args() == 0); zero_args or args.is_set("-h")) {
+        std::cout << USAGE << '\n';
+        return zero_args ? 1 : 0;
+    }
+
+    if (auto invalid_arg = args.check_args(std::set<std::string>{"-i", "-f"}); invalid_arg) {
+        std::cout << "Unknown argument \"" << *invalid_arg << "\".\n";
+        std::cout << "Use -h to print help.\n";
+        return 1;
+    }
+
+    try {
+        const auto i = std::filesystem::path{strip_quotes(args.get("-i").value_or(""))};
+        const auto f = std::filesystem::path{strip_quotes(args.get("-f").value_or(""))};
+
+        if (args.is_set("-i") and i.empty()) {
+            std::cerr << "Error: Value of -i has to be a valid file name\n";
+            return 1;
+        }
+
+        if (f.empty()) {
+            std::cerr << "Error: Value of -f has to be a valid file name\n";
+            return 1;
+        }
+
+        const auto rows = i.empty() ? decode_stream() : codec::decode_file(i);
+        const auto bytes = std::as_bytes(std::span{rows});
+
+        std::ofstream out(f, std::ios::binary | std::ios::trunc);
+        if (not out.write(reinterpret_cast<const char*>(bytes.data()),   // NOLINT
+                          static_cast<std::streamsize>(bytes.size()))) {
+            throw std::system_error(errno, std::generic_category(), f.string());
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
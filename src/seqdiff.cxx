@@ -1,21 +1,32 @@
 #include "ais.hpp"
 #include "argparse.hpp"
+#include "async_writer.hpp"
+#include "codec.hpp"
+#include "histogram.hpp"
+#include "io.hpp"
 #include "seq_diff.hpp"
 #include "utility.hpp"
 
-#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 static constexpr auto USAGE = R"(seqdiff
 
     Determines adjacent differences of time and position of AIS data with a common MMSI, where the
-    data stream is read from standard input.
+    data stream is read from standard input (or the files of --input).
 
     The first five columns of the input data are interpreted as
      (1) Time of AIS message reception as UTC epoch, e.g., 1456786800.005
@@ -35,12 +46,60 @@ static constexpr auto USAGE = R"(seqdiff
 
     Options:
         -h                Prints this message.
-        -s [stride]       The stride (default 1).
+        -s [strides]      The stride (default 1) or a comma-separated list of strides and ranges
+                          thereof, e.g., "1-4,8", which are all determined in a single pass.
+                          The results of each stride k are written to a file of its own, whose
+                          name is the one of -f with the suffix "_s<k>" appended to its stem,
+                          e.g., "dump_s8.bin" for -f "dump.bin".
         -d "[delimiter]"  The delimiter used to separate columns (default ", ").
+        -j [threads]      Number of threads used to parse and process the input (default 1).
+        -r                Group and order the input by a radix sort on (MMSI, time). Of several
+                          positions with a common MMSI and time the first one read is kept.
+        --mem-limit [MiB] Memory budget for the staged input in MiB. Once exceeded, the input is
+                          partitioned by MMSI into temporary files and the partitions are
+                          processed one after another (default 0, i.e., no limit).
+        --metric [name]   The distance metric, one of "equirectangular" (default), "haversine" or
+                          "flat". The latter is the equirectangular metric without square roots
+                          where distances are compared against thresholds.
+        --input [files]   Read the given files instead of standard input, where the value is a
+                          comma-separated list of file names and glob patterns, e.g.,
+                          "data/2016-03-*.csv". The option can be repeated, which is the same as
+                          joining the lists. Names that contain a comma have to be given as a
+                          pattern, e.g., with '?' in place of the comma. The files are read as if
+                          they were concatenated in the given order, where the matches of each
+                          pattern are sorted by name. With at least -j files, each file is read
+                          and parsed by a thread of its own, otherwise the files are read one
+                          after another.
+        --from-cache [file]
+                          Map the positions of a cache file (cf. seqmaker --build-cache) instead
+                          of reading standard input. The results are the same as when reading
+                          the original input with -r.
+        --format [name]   The output format, one of "raw" (default) or "packed". Packed output holds
+                          the differences zigzag-encoded and bit-packed in blocks of 128 pairs and
+                          is decoded to the raw format by seqdecode or seqmaker::codec::decode
+                          (cf. codec.hpp).
+        --hist            Write a histogram of the differences to the output file instead of the
+                          differences themselves, where each line lists the lower and upper
+                          edges of a bin in time and position and its count. The first and last
+                          bins of each axis count the values below and above its range. Memory
+                          scales with the number of bins instead of the number of differences.
+        --dt-bins [min,max,n[,log]]
+                          Binning of the temporal differences in seconds with --hist, i.e., n
+                          bins of equal width in [min, max) or, with log, of equal width in
+                          log(dt) (default 1,86400,100,log).
+        --dx-bins [min,max,n[,log]]
+                          Binning of the spatial differences in 1/10000 nautical miles with
+                          --hist (default 1,10000000,100,log).
         -f                The name of the output file for the binary data.)";
 
 static constexpr auto ARG_d_DEFAULT = ", ";
 static constexpr auto ARG_s_DEFAULT = "1";
+static constexpr auto ARG_j_DEFAULT = "1";
+static constexpr auto ARG_mem_limit_DEFAULT = "0";
+static constexpr auto ARG_metric_DEFAULT = "equirectangular";
+static constexpr auto ARG_format_DEFAULT = "raw";
+static constexpr auto ARG_dt_bins_DEFAULT = "1,86400,100,log";
+static constexpr auto ARG_dx_bins_DEFAULT = "1,10000000,100,log";
 
 [[nodiscard]] auto strip_quotes(std::string str) noexcept {
     if (auto n = str.size(); n > 2 and str.starts_with('\"') and str.ends_with('\"')) {
@@ -50,24 +109,88 @@ static constexpr auto ARG_s_DEFAULT = "1";
     return str;
 }
 
-void dump_seq(
-    const std::vector<std::pair<seqmaker::ais::time_t, seqmaker::ais::Point::value_type>>& seq,
-    const std::filesystem::path& path) {
-    std::ofstream f(path, std::ios::binary);
-    for (auto p : seq) {
-        constexpr auto Nt = sizeof(decltype(p.first));
-        constexpr auto Nx = sizeof(decltype(p.second));
+/*
+ * Strides of the form "1-4,8" in ascending order without duplicates, or none if invalid.
+ */
+[[nodiscard]] std::vector<unsigned> to_strides(std::string_view str) noexcept {
+    using seqmaker::utility::to;
+    constexpr int MAX_STRIDE = 1 << 20;
 
-        std::array<char, Nt + Nx> bytes;   // NOLINT
+    std::vector<unsigned> strides;
+    for (std::size_t first = 0; first <= str.size();) {
+        const auto last = std::min(str.find(',', first), str.size());
+        const auto item = str.substr(first, last - first);
+        const auto dash = item.find('-');
+        const auto a = to<int>(item.substr(0, dash), 0);
+        const auto b = dash == std::string_view::npos ? a : to<int>(item.substr(dash + 1), 0);
+        if (a <= 0 or b < a or b > MAX_STRIDE) {
+            return {};
+        }
+        for (auto k = a; k <= b; k++) {
+            strides.emplace_back(static_cast<unsigned>(k));
+        }
+        first = last + 1;
+    }
+
+    std::sort(strides.begin(), strides.end());
+    strides.erase(std::unique(strides.begin(), strides.end()), strides.end());
+    return strides;
+}
+
+/*
+ * Output file of the k-th stride, cf. -s.
+ */
+[[nodiscard]] std::filesystem::path stride_path(const std::filesystem::path& path,
+                                                std::span<const unsigned> strides,
+                                                std::size_t k) {
+    if (strides.size() == 1) {
+        return path;
+    }
 
-        // cppcheck-suppress containerOutOfBounds
-        std::memcpy(&bytes[0], &(p.first), Nt);   // NOLINT
+    auto file = path;
+    file.replace_filename(path.stem().string() + "_s" + std::to_string(strides[k]));
+    return file.concat(path.extension().string());
+}
 
-        // cppcheck-suppress containerOutOfBounds
-        std::memcpy(&bytes[Nx], &(p.second), Nx);   // NOLINT
+void dump_seq(seqmaker::io::AsyncWriter& writer,
+              std::span<const seqmaker::SequenceDiff::Diff> seq,
+              const std::filesystem::path& path,
+              seqmaker::codec::Format format) {
+    constexpr auto Nt = sizeof(seqmaker::SequenceDiff::Diff::first_type);
+    constexpr auto Nx = sizeof(seqmaker::SequenceDiff::Diff::second_type);
 
-        // cppcheck-suppress containerOutOfBounds
-        f.write(&bytes[0], Nt + Nx);   // NOLINT
+    std::vector<char> bytes;
+    if (format == seqmaker::codec::Format::packed) {
+        // differences are small already and are not delta encoded once more
+        std::vector<std::uint32_t> rows(2 * seq.size());
+        for (std::size_t i = 0; i < seq.size(); i++) {
+            rows[2 * i] = seq[i].first;
+            rows[2 * i + 1] = static_cast<std::uint32_t>(seq[i].second);
+        }
+        seqmaker::codec::encode(rows, 2, false, bytes);
+    } else {
+        bytes.resize((Nt + Nx) * seq.size());
+        for (std::size_t i = 0; i < seq.size(); i++) {
+            std::memcpy(&bytes[(Nt + Nx) * i], &(seq[i].first), Nt);         // NOLINT
+            std::memcpy(&bytes[(Nt + Nx) * i + Nt], &(seq[i].second), Nx);   // NOLINT
+        }
+    }
+
+    writer.write(path, std::move(bytes), std::ios::app);
+}
+
+void dump_hist(const seqmaker::Histogram2D& hist, const std::filesystem::path& path) {
+    std::ofstream f(path);
+    f << "# dt_low dt_high dx_low dx_high count\n";
+    for (std::size_t i = 0; i < hist.x().n_bins() + std::size_t{2}; i++) {
+        for (std::size_t j = 0; j < hist.y().n_bins() + std::size_t{2}; j++) {
+            f << hist.x().edge(i) << ' ' << hist.x().edge(i + 1) << ' ' << hist.y().edge(j) << ' '
+              << hist.y().edge(j + 1) << ' ' << hist.count(i, j) << '\n';
+        }
+    }
+
+    if (not f.flush()) {
+        throw std::system_error(errno, std::generic_category(), path.string());
     }
 }
 
@@ -80,7 +203,10 @@ int main(int argc, const char** argv) {
         return zero_args ? 1 : 0;
     }
 
-    if (auto invalid_arg = args.check_args(std::set<std::string>{"-s", "-d", "-f"}); invalid_arg) {
+    if (auto invalid_arg = args.check_args(std::set<std::string>{
+            "-s", "-d", "-f", "-j", "-r", "--mem-limit", "--metric", "--from-cache", "--format",
+            "--hist", "--dt-bins", "--dx-bins", "--input"});
+        invalid_arg) {
         std::cout << "Unknown argument \"" << *invalid_arg << "\".\n";
         std::cout << "Use -h to print help.\n";
         return 1;
@@ -96,11 +222,80 @@ int main(int argc, const char** argv) {
     d = replace_char(d, "\\t", '\t');
 
     try {
-        const auto s = utility::to<int>(args.get("-s").value_or(ARG_s_DEFAULT), 0);
+        const auto strides = to_strides(args.get("-s").value_or(ARG_s_DEFAULT));
+        const auto j = utility::to<int>(args.get("-j").value_or(ARG_j_DEFAULT), 0);
+        const auto m
+            = utility::to<int>(args.get("--mem-limit").value_or(ARG_mem_limit_DEFAULT), -1);
+        const auto metric = ais::to_metric(args.get("--metric").value_or(ARG_metric_DEFAULT));
         const auto f = std::filesystem::path{strip_quotes(args.get("-f").value_or(""))};
+        const auto from_cache = strip_quotes(args.get("--from-cache").value_or(""));
+        const auto format = codec::to_format(args.get("--format").value_or(ARG_format_DEFAULT));
+        const auto dt_bins = to_axis(args.get("--dt-bins").value_or(ARG_dt_bins_DEFAULT));
+        const auto dx_bins = to_axis(args.get("--dx-bins").value_or(ARG_dx_bins_DEFAULT));
+        const auto input = [&args]() {
+            std::string list;
+            for (const auto& value : args.get_all("--input")) {
+                if (not list.empty()) {
+                    list += ',';
+                }
+                list += strip_quotes(value);
+            }
+            return list;
+        }();
+
+        if (strides.empty()) {
+            std::cerr << "Error: Value of -s has to be a list of non-zero and positive strides\n";
+            return 1;
+        }
+
+        if (j <= 0) {
+            std::cerr << "Error: Value of -j has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (m < 0) {
+            std::cerr << "Error: Value of --mem-limit has to be zero or positive\n";
+            return 1;
+        }
+
+        if (not metric) {
+            std::cerr << "Error: Value of --metric has to be a known metric\n";
+            return 1;
+        }
+
+        if (args.is_set("--from-cache") and from_cache.empty()) {
+            std::cerr << "Error: Value of --from-cache has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--input") and input.empty()) {
+            std::cerr << "Error: Value of --input has to be a list of file names or patterns\n";
+            return 1;
+        }
+
+        if (args.is_set("--input") and args.is_set("--from-cache")) {
+            std::cerr << "Error: Option --input is incompatible with --from-cache\n";
+            return 1;
+        }
+
+        if (not format) {
+            std::cerr << "Error: Value of --format has to be a known format\n";
+            return 1;
+        }
 
-        if (s <= 0) {
-            std::cerr << "Error: Value of -s has to be non-zero and positive\n";
+        if (args.is_set("--hist") and not dt_bins) {
+            std::cerr << "Error: Value of --dt-bins has to be of the form min,max,n[,log]\n";
+            return 1;
+        }
+
+        if (args.is_set("--hist") and not dx_bins) {
+            std::cerr << "Error: Value of --dx-bins has to be of the form min,max,n[,log]\n";
+            return 1;
+        }
+
+        if (args.is_set("--hist") and *format != codec::Format::raw) {
+            std::cerr << "Error: Option --hist is incompatible with --format "
+                      << codec::to_string(*format) << '\n';
             return 1;
         }
 
@@ -109,11 +304,47 @@ int main(int argc, const char** argv) {
             return 1;
         }
 
-        const auto us = static_cast<unsigned>(s);
-        dump_seq(SequenceDiff{d}.run(us), f);
+        const auto uj = static_cast<unsigned>(j);
+        const auto um = static_cast<std::size_t>(m) << 20U;   // MiB
+        const auto input_files = io::glob(input);
+        const input_args input_args{.delimiter = d,
+                                    .n_threads = uj,
+                                    .radix_sort = args.is_set("-r"),
+                                    .mem_limit = um,
+                                    .cache = from_cache,
+                                    .files = input_files};
+
+        if (args.is_set("--hist")) {
+            const auto hists = SequenceDiff{input_args, *metric}.run(
+                strides, Histogram2D{*dt_bins, *dx_bins});
+            for (std::size_t k = 0; k < strides.size(); k++) {
+                dump_hist(hists[k], stride_path(f, strides, k));
+            }
+            return 0;
+        }
+
+        std::vector<std::filesystem::path> files;
+        for (std::size_t k = 0; k < strides.size(); k++) {
+            files.emplace_back(stride_path(f, strides, k));
+        }
+
+        // differences are written while further trajectories are processed
+        io::AsyncWriter writer{1};
+        for (const auto& file : files) {
+            writer.write(file, {}, std::ios::trunc);
+        }
+        SequenceDiff{input_args, *metric}.run(
+            strides,
+            [&writer, &files, &format](std::size_t k, std::span<const SequenceDiff::Diff> diffs) {
+                dump_seq(writer, diffs, files[k], *format);
+            });
+        writer.finish();
     } catch (const std::invalid_argument& e) {
         std::cerr << e.what() << '\n';
         return 1;
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
     return 0;
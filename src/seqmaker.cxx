@@ -1,24 +1,39 @@
 #include "ais.hpp"
 #include "argparse.hpp"
+#include "async_writer.hpp"
+#include "codec.hpp"
+#include "io.hpp"
 #include "mmsi_counter.hpp"
+#include "pack_file.hpp"
 #include "seq_counter.hpp"
 #include "seq_maker.hpp"
+#include "seq_streamer.hpp"
+#include "seq_sweep.hpp"
+#include "stats.hpp"
+#include "trajectory_cache.hpp"
 #include "utility.hpp"
 
-#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 static constexpr auto USAGE = R"(seqmaker
 
-    Gathers lines of AIS data from standard input as sequences by MMSI.
+    Gathers lines of AIS data from standard input (or the files of --input) as sequences by MMSI.
     Sequences of a common MMSI are split by length and if consecutive points deviate significantly.
     The resulting sequences are split until they have the target length. Remaining parts are
     discarded.
@@ -45,7 +60,8 @@ static constexpr auto USAGE = R"(seqmaker
 
     Options:
         -h                Prints this message.
-        -c                Only count MMSI occurences and suppress generation of args.txt.
+        -c                Only count MMSI occurences and suppress generation of args.txt. The
+                          counts are printed in descending order using -j threads.
         -S                Suppress generation of files and print drop-rate of selection.
         -d "[delimiter]"  The delimiter used to separate columns (default ", ").
         -N [number]       Sequence length N, corresponding to a temporal duration of
@@ -57,6 +73,65 @@ static constexpr auto USAGE = R"(seqmaker
         -p [dir]          Parent directories for generated files (default ./).
         -l                Apply simple one-step low pass filter using given spatial threshold.
         -v [kt]           Minimal average speed in kt on interpolated sequence (default 0 kt).
+        -j [threads]      Number of threads used to parse and process the input (default 1).
+        -r                Group and order the input by a radix sort on (MMSI, time). Of several
+                          positions with a common MMSI and time the first one read is kept.
+        --mem-limit [MiB] Memory budget for the staged input in MiB. Once exceeded, the input is
+                          partitioned by MMSI into temporary files and the partitions are
+                          processed one after another (default 0, i.e., no limit).
+        --metric [name]   The distance metric, one of "equirectangular" (default), "haversine" or
+                          "flat". The latter is the equirectangular metric without square roots
+                          where distances are compared against thresholds.
+        --streaming [seconds]
+                          Process the input as a stream that is ordered by time up to the given
+                          reorder window (default 0 seconds) and write the completed sequences
+                          in batches per MMSI. Older positions of a vessel are dropped. Memory
+                          scales with the number of vessels seen within the last -t seconds.
+        --input [files]   Read the given files instead of standard input, where the value is a
+                          comma-separated list of file names and glob patterns, e.g.,
+                          "data/2016-03-*.csv". The option can be repeated, which is the same as
+                          joining the lists. Names that contain a comma have to be given as a
+                          pattern, e.g., with '?' in place of the comma. The files are read as if
+                          they were concatenated in the given order, where the matches of each
+                          pattern are sorted by name. With at least -j files, each file is read
+                          and parsed by a thread of its own, otherwise the files are read one
+                          after another.
+        --build-cache [file]
+                          Only parse the input and write the valid positions, grouped and ordered
+                          by (MMSI, time) as with -r, to a binary cache file (cf. --from-cache).
+        --from-cache [file]
+                          Map the positions of a cache file (cf. --build-cache) instead of reading
+                          standard input. The results are the same as when reading the original
+                          input with -r, apart from -d, which applies at build time only.
+        --sweep [file]    Read, group and order the input once and process it for each
+                          configuration of -N, -t, -s, -i and -v in the given file. Each line of
+                          the file lists options with comma-separated values, e.g.,
+                          "-N 360,720 -s .1,.5", and stands for all combinations thereof, where
+                          omitted options keep the values of the command line. Empty lines and
+                          lines starting with # are ignored. The results of the k-th configuration
+                          are written to the subdirectory k of -p with its own args.txt (with -S,
+                          the drop-rates are written to drop_rates.txt) and a summary of
+                          the number of sequences and the drop-rate (as with -S, i.e., regardless
+                          of -v) of each configuration is printed.
+        --pack [file]     Write all sequences to a single pack file in the directory of -p
+                          instead of one file per MMSI. The file holds an index of the MMSIs and
+                          the byte offsets and numbers of their points, followed by the points of
+                          all MMSIs in the format of the .bin files (cf. pack_file.hpp).
+        --writers [threads]
+                          Number of threads that write files in the background while further
+                          sequences are computed (default 1). Pending output is limited to
+                          64 MiB, beyond which the computation waits for the writers.
+        --format [name]   The output format, one of "raw" (default) or "packed". Packed files
+                          (extension .pbin instead of .bin) hold the differences of consecutive
+                          points, zigzag-encoded and bit-packed in blocks of 128 points, and are
+                          decoded to the raw format by seqdecode or seqmaker::codec::decode
+                          (cf. codec.hpp).
+        --stats [file]    Record the wall and CPU time of each stage of the pipeline and counters
+                          of the rows read, rejected and deduplicated, the trajectories and
+                          sequences processed and the bytes written, and write them together
+                          with the peak resident memory as JSON to the given file at exit.
+                          Times of a stage include the ones of its nested stages, e.g., input
+                          includes parse and process includes split and dump (cf. stats.hpp).
 )";
 
 static constexpr auto ARG_d_DEFAULT = ", ";
@@ -66,6 +141,12 @@ static constexpr auto ARG_s_DEFAULT = ".1";
 static constexpr auto ARG_i_DEFAULT = "6";
 static constexpr auto ARG_p_DEFAULT = "";
 static constexpr auto ARG_v_DEFAULT = "0.";
+static constexpr auto ARG_j_DEFAULT = "1";
+static constexpr auto ARG_mem_limit_DEFAULT = "0";
+static constexpr auto ARG_streaming_DEFAULT = "0";
+static constexpr auto ARG_metric_DEFAULT = "equirectangular";
+static constexpr auto ARG_writers_DEFAULT = "1";
+static constexpr auto ARG_format_DEFAULT = "raw";
 
 [[nodiscard]] auto strip_quotes(std::string str) noexcept {
     if (auto n = str.size(); n > 2 and str.starts_with('\"') and str.ends_with('\"')) {
@@ -82,6 +163,9 @@ void dump_args(std::string_view delimiter,
                unsigned dti,
                double v,
                bool lpf,
+               seqmaker::ais::Metric metric,
+               const std::string& pack,
+               seqmaker::codec::Format format,
                const std::filesystem::path& path) {
     std::ofstream f(path / "args.txt");
     f << "-d " << delimiter << ' ';
@@ -93,28 +177,161 @@ void dump_args(std::string_view delimiter,
     if (lpf) {
         f << "-l ";
     }
+    f << "--metric " << seqmaker::ais::to_string(metric) << ' ';
+    if (not pack.empty()) {
+        f << "--pack " << pack << ' ';
+    }
+    if (format != seqmaker::codec::Format::raw) {
+        f << "--format " << seqmaker::codec::to_string(format) << ' ';
+    }
     f << "-p " << path << '\n';
 }
 
-void dump_seq(seqmaker::ais::mmsi_t mmsi,
-              const std::vector<seqmaker::ais::Point>& seq,
-              const std::filesystem::path& path) {
-    const auto fname = (path / std::to_string(mmsi)).concat(".bin");
-    std::ofstream f(fname, std::ios::binary);
-    for (auto p : seq) {
-        constexpr auto N = sizeof(decltype(p)::value_type);
+void dump_seq(seqmaker::io::AsyncWriter& writer,
+              seqmaker::ais::mmsi_t mmsi,
+              std::span<const seqmaker::ais::Point> seq,
+              const std::filesystem::path& path,
+              seqmaker::codec::Format format,
+              std::ios::openmode mode = std::ios::trunc) {
+    const seqmaker::stats::Scope scope{seqmaker::stats::Stage::dump,
+                                       seqmaker::stats::Clock::thread};
+    constexpr auto N = sizeof(seqmaker::ais::Point::value_type);
+
+    std::vector<char> bytes;
+    if (format == seqmaker::codec::Format::packed) {
+        // consecutive points of a sequence differ by small amounts
+        std::vector<std::uint32_t> rows(2 * seq.size());
+        for (std::size_t i = 0; i < seq.size(); i++) {
+            rows[2 * i] = static_cast<std::uint32_t>(seq[i].latitude);
+            rows[2 * i + 1] = static_cast<std::uint32_t>(seq[i].longitude);
+        }
+        seqmaker::codec::encode(rows, 2, true, bytes);
+    } else {
+        bytes.resize(2 * N * seq.size());
+        for (std::size_t i = 0; i < seq.size(); i++) {
+            std::memcpy(&bytes[2 * N * i], &(seq[i].latitude), N);        // NOLINT
+            std::memcpy(&bytes[2 * N * i + N], &(seq[i].longitude), N);   // NOLINT
+        }
+    }
+
+    const auto file = (path / std::to_string(mmsi)).concat(seqmaker::codec::extension(format));
+    seqmaker::stats::add(seqmaker::stats::Counter::bytes_written, bytes.size());
+    writer.write(file, std::move(bytes), mode);
+}
+
+void write_pack(const std::filesystem::path& path, const seqmaker::PackFile::Sequences& seqs) {
+    const seqmaker::stats::Scope scope{seqmaker::stats::Stage::write};
+    seqmaker::PackFile::write(path, seqs);
+    if (seqmaker::stats::enabled()) {
+        seqmaker::stats::add(seqmaker::stats::Counter::bytes_written,
+                             std::filesystem::file_size(path));
+    }
+}
+
+/*
+ * Gathers the sequences of a stream per MMSI and writes them once the gathered points exceed a
+ * limit, i.e., each file is appended to once per flush instead of once per sequence. The first
+ * write of an MMSI replaces the file of a previous invocation.
+ */
+class StreamDump {
+  private:
+    static constexpr std::size_t MAX_POINTS = std::size_t{1} << 20U;
+
+    seqmaker::io::AsyncWriter& writer_;
+    std::filesystem::path path_;
+    seqmaker::codec::Format format_;
+    std::unordered_map<seqmaker::ais::mmsi_t, std::vector<seqmaker::ais::Point>> seqs_;
+    std::unordered_set<seqmaker::ais::mmsi_t> dumped_;
+    std::size_t n_points_ = 0;
+
+  public:
+    StreamDump(seqmaker::io::AsyncWriter& writer,
+               std::filesystem::path path,
+               seqmaker::codec::Format format)
+        : writer_(writer)
+        , path_(std::move(path))
+        , format_(format) {
+    }
+
+    void push(seqmaker::ais::mmsi_t mmsi, std::span<const seqmaker::ais::Point> seq) {
+        auto& points = seqs_[mmsi];
+        points.insert(points.end(), seq.begin(), seq.end());
+        n_points_ += seq.size();
+        if (n_points_ >= MAX_POINTS) {
+            flush();
+        }
+    }
+
+    void flush() {
+        for (const auto& [mmsi, points] : seqs_) {
+            const auto mode = dumped_.insert(mmsi).second ? std::ios::trunc : std::ios::app;
+            dump_seq(writer_, mmsi, points, path_, format_, mode);
+        }
+        seqs_.clear();
+        n_points_ = 0;
+    }
+};
+
+/*
+ * Writes the statistics to the given file, if any, when going out of scope, i.e., on every return
+ * path of main.
+ */
+class StatsReport {
+  private:
+    std::filesystem::path path_;
+
+  public:
+    explicit StatsReport(std::filesystem::path path)
+        : path_(std::move(path)) {
+        if (not path_.empty()) {
+            seqmaker::stats::enable();
+        }
+    }
+
+    ~StatsReport() {
+        if (path_.empty()) {
+            return;
+        }
+
+        try {
+            seqmaker::stats::write_json(path_);
+        } catch (const std::system_error& e) {
+            std::cerr << "Error: " << e.what() << '\n';
+        }
+    }
+
+    StatsReport(const StatsReport&) = delete;
+
+    StatsReport(StatsReport&&) = delete;
 
-        std::array<char, 2 * N> bytes;   // NOLINT
+    StatsReport& operator=(const StatsReport&) = delete;
 
-        // cppcheck-suppress containerOutOfBounds
-        std::memcpy(&bytes[0], &(p.latitude), N);   // NOLINT
+    StatsReport& operator=(StatsReport&&) = delete;
+};
 
-        // cppcheck-suppress containerOutOfBounds
-        std::memcpy(&bytes[N], &(p.longitude), N);   // NOLINT
+/*
+ * Reads the configurations of a sweep, cf. seqmaker::expand_grid.
+ */
+[[nodiscard]] std::vector<seqmaker::split_args> read_sweep(const std::filesystem::path& path,
+                                                           const seqmaker::split_args& defaults) {
+    std::ifstream f(path);
+    if (not f) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+
+    std::vector<seqmaker::split_args> configs;
+    for (std::string line; std::getline(f, line);) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos or line.starts_with('#')) {
+            continue;
+        }
+        const auto grid = seqmaker::expand_grid(line, defaults);
+        configs.insert(configs.end(), grid.begin(), grid.end());
+    }
 
-        // cppcheck-suppress containerOutOfBounds
-        f.write(&bytes[0], 2 * N);   // NOLINT
+    if (configs.empty()) {
+        throw std::invalid_argument("Invalid sweep. " + path.string() + " has no configuration.");
     }
+    return configs;
 }
 
 int main(int argc, const char** argv) {
@@ -126,8 +343,10 @@ int main(int argc, const char** argv) {
         return zero_args ? 1 : 0;
     }
 
-    if (auto invalid_arg = args.check_args(
-            std::set<std::string>{"-c", "-S", "-d", "-N", "-t", "-s", "-i", "-l", "-p", "-v"});
+    if (auto invalid_arg = args.check_args(std::set<std::string>{
+            "-c", "-S", "-d", "-N", "-t", "-s", "-i", "-l", "-p", "-v", "-j", "-r", "--mem-limit",
+            "--streaming", "--metric", "--build-cache", "--from-cache", "--sweep",
+            "--pack", "--writers", "--format", "--stats", "--input"});
         invalid_arg) {
         std::cout << "Unknown argument \"" << *invalid_arg << "\".\n";
         std::cout << "Use -h to print help.\n";
@@ -144,31 +363,37 @@ int main(int argc, const char** argv) {
     d = replace_char(d, "\\t", '\t');
 
     try {
-        if (args.is_set("-c")) {
-            for (auto [mmsi, n] : count_mmsi(d)) {
-                std::cout << mmsi << ": " << n << '\n';
-            }
-            return 0;
-        }
-
-        /*
-         * TODO: workaround until compiler support std::from_chars for double
-         */
-        auto str2d = [](const std::string& str, double fallback) {
-            try {
-                return std::stod(str);
-            } catch (const std::invalid_argument&) {
-                return fallback;
-            }
-        };
-
         const auto N = utility::to<int>(args.get("-N").value_or(ARG_N_DEFAULT), 0);
         const auto t = utility::to<int>(args.get("-t").value_or(ARG_t_DEFAULT), 0);
         const auto i = utility::to<int>(args.get("-i").value_or(ARG_i_DEFAULT), 0);
-        const auto s = str2d(args.get("-s").value_or(ARG_s_DEFAULT), 0.);
-        const auto v = str2d(args.get("-v").value_or(ARG_v_DEFAULT), -1.);
+        const auto s = utility::to<double>(args.get("-s").value_or(ARG_s_DEFAULT), 0.);
+        const auto v = utility::to<double>(args.get("-v").value_or(ARG_v_DEFAULT), -1.);
+        const auto j = utility::to<int>(args.get("-j").value_or(ARG_j_DEFAULT), 0);
+        const auto m
+            = utility::to<int>(args.get("--mem-limit").value_or(ARG_mem_limit_DEFAULT), -1);
+        const auto w
+            = utility::to<int>(args.get("--streaming").value_or(ARG_streaming_DEFAULT), -1);
         const auto lpf = args.is_set("-l");
+        const auto metric = ais::to_metric(args.get("--metric").value_or(ARG_metric_DEFAULT));
         const auto p = std::filesystem::path{strip_quotes(args.get("-p").value_or(ARG_p_DEFAULT))};
+        const auto build_cache = strip_quotes(args.get("--build-cache").value_or(""));
+        const auto from_cache = strip_quotes(args.get("--from-cache").value_or(""));
+        const auto sweep = strip_quotes(args.get("--sweep").value_or(""));
+        const auto pack = strip_quotes(args.get("--pack").value_or(""));
+        const auto n_writers
+            = utility::to<int>(args.get("--writers").value_or(ARG_writers_DEFAULT), 0);
+        const auto format = codec::to_format(args.get("--format").value_or(ARG_format_DEFAULT));
+        const auto stats_file = strip_quotes(args.get("--stats").value_or(""));
+        const auto input = [&args]() {
+            std::string list;
+            for (const auto& value : args.get_all("--input")) {
+                if (not list.empty()) {
+                    list += ',';
+                }
+                list += strip_quotes(value);
+            }
+            return list;
+        }();
 
         if (N <= 0) {
             std::cerr << "Error: Value of -N has to be non-zero and positive\n";
@@ -195,36 +420,248 @@ int main(int argc, const char** argv) {
             return 1;
         }
 
+        if (j <= 0) {
+            std::cerr << "Error: Value of -j has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (m < 0) {
+            std::cerr << "Error: Value of --mem-limit has to be zero or positive\n";
+            return 1;
+        }
+
+        if (w < 0) {
+            std::cerr << "Error: Value of --streaming has to be zero or positive\n";
+            return 1;
+        }
+
+        if (not metric) {
+            std::cerr << "Error: Value of --metric has to be a known metric\n";
+            return 1;
+        }
+
+        if (args.is_set("--build-cache") and build_cache.empty()) {
+            std::cerr << "Error: Value of --build-cache has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--from-cache") and from_cache.empty()) {
+            std::cerr << "Error: Value of --from-cache has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--sweep") and sweep.empty()) {
+            std::cerr << "Error: Value of --sweep has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--pack") and pack.empty()) {
+            std::cerr << "Error: Value of --pack has to be a valid file name\n";
+            return 1;
+        }
+
+        if (n_writers <= 0) {
+            std::cerr << "Error: Value of --writers has to be non-zero and positive\n";
+            return 1;
+        }
+
+        if (not format) {
+            std::cerr << "Error: Value of --format has to be a known format\n";
+            return 1;
+        }
+
+        if (args.is_set("--stats") and stats_file.empty()) {
+            std::cerr << "Error: Value of --stats has to be a valid file name\n";
+            return 1;
+        }
+
+        if (args.is_set("--input") and input.empty()) {
+            std::cerr << "Error: Value of --input has to be a list of file names or patterns\n";
+            return 1;
+        }
+
+        if (args.is_set("--input") and args.is_set("--from-cache")) {
+            std::cerr << "Error: Option --input is incompatible with --from-cache\n";
+            return 1;
+        }
+
+        if (not pack.empty() and *format != codec::Format::raw) {
+            std::cerr << "Error: Option --pack is incompatible with --format "
+                      << codec::to_string(*format) << '\n';
+            return 1;
+        }
+
         const auto uN = static_cast<unsigned>(N);
         const auto ut = static_cast<unsigned>(t);
         const auto ui = static_cast<unsigned>(i);
+        const auto uj = static_cast<unsigned>(j);
+        const auto um = static_cast<std::size_t>(m) << 20U;   // MiB
+
+        const StatsReport stats_report{stats_file};
+        const auto input_files = io::glob(input);
+
+        if (args.is_set("-c")) {
+            if (args.is_set("--from-cache")) {
+                std::cerr << "Error: Option -c is incompatible with --from-cache\n";
+                return 1;
+            }
+            for (auto [mmsi, n] : count_mmsi(d, uj, input_files)) {
+                std::cout << mmsi << ": " << n << '\n';
+            }
+            return 0;
+        }
+
+        if (args.is_set("--build-cache")) {
+            if (args.is_set("--from-cache")) {
+                std::cerr << "Error: Option --build-cache is incompatible with --from-cache\n";
+                return 1;
+            }
+            TrajectoryCache::build(build_cache, d, uj, input_files);
+            return 0;
+        }
 
         if (not p.empty()) {
             std::filesystem::create_directory(p);
         }
-        dump_args(args.get("-d").value_or(std::string{ARG_d_DEFAULT}), uN, ut, s, ui, v, lpf, p);
+        if (not args.is_set("--sweep")) {
+            dump_args(args.get("-d").value_or(std::string{ARG_d_DEFAULT}),
+                      uN,
+                      ut,
+                      s,
+                      ui,
+                      v,
+                      lpf,
+                      *metric,
+                      pack,
+                      *format,
+                      p);
+        }
 
         const split_args split_args{.seq_length = uN,
                                     .dt_max = ut,
                                     .dti = ui,
                                     .ds_max = s,
-                                    .v_min = v};
-        if (args.is_set("-S")) {
+                                    .v_min = v,
+                                    .metric = *metric};
+        const input_args input_args{.delimiter = d,
+                                    .n_threads = uj,
+                                    .radix_sort = args.is_set("-r"),
+                                    .mem_limit = um,
+                                    .cache = from_cache,
+                                    .files = input_files};
+        io::AsyncWriter writer{static_cast<unsigned>(n_writers)};
+        if (args.is_set("--streaming")) {
+            for (const auto* option :
+                 {"-S", "-r", "--mem-limit", "--from-cache", "--sweep", "--pack"}) {
+                if (args.is_set(option)) {
+                    std::cerr << "Error: Option --streaming is incompatible with " << option
+                              << '\n';
+                    return 1;
+                }
+            }
+
+            // sequences are passed on by one thread at a time
+            StreamDump dump{writer, p, *format};
+            auto sink = [&dump](ais::mmsi_t mmsi, std::span<const ais::Point> seq) {
+                dump.push(mmsi, seq);
+            };
+
+            const stream_args stream_args{.reorder_window = static_cast<unsigned>(w),
+                                          .apply_low_pass_filter = lpf};
+            SequenceStreamer streamer{split_args, stream_args, sink};
+            streamer.run(d, uj, input_files);
+            dump.flush();
+            if (auto n = streamer.n_dropped(); n > 0) {
+                std::cerr << "Warning: Dropped " << n << " positions outside the reorder window\n";
+            }
+        } else if (args.is_set("--sweep")) {
+            const auto configs = read_sweep(sweep, split_args);
+            const auto count_only = args.is_set("-S");
+            if (count_only) {
+                for (const auto& config : configs) {
+                    if (config.v_min > 0.) {
+                        std::cerr << "Error: Option -S is incompatible with v > 0.\n";
+                        return 1;
+                    }
+                }
+            }
+
+            std::vector<std::filesystem::path> dirs;
+            for (std::size_t k = 0; k < configs.size(); k++) {
+                const auto& config = configs[k];
+                const auto& dir = dirs.emplace_back(p / std::to_string(k));
+                std::filesystem::create_directory(dir);
+                dump_args(args.get("-d").value_or(std::string{ARG_d_DEFAULT}),
+                          config.seq_length,
+                          config.dt_max,
+                          config.ds_max,
+                          config.dti,
+                          config.v_min,
+                          lpf,
+                          config.metric,
+                          pack,
+                          *format,
+                          dir);
+            }
+
+            // sequences are written while further trajectories are processed, except for pack
+            // files whose index is laid out once all sequences of a configuration are known
+            SequenceSweep sweep{configs, input_args};
+            const auto results =
+                count_only or not pack.empty()
+                    ? sweep.run(lpf, count_only)
+                    : sweep.run(lpf,
+                                [&writer, &dirs, &format](std::size_t k,
+                                                          ais::mmsi_t mmsi,
+                                                          std::span<const ais::Point> seq) {
+                                    dump_seq(writer, mmsi, seq, dirs[k], *format);
+                                });
+
+            std::cout << "config N t s i v sequences drop_rate\n";
+            for (std::size_t k = 0; k < configs.size(); k++) {
+                const auto& config = configs[k];
+                const auto& result = results[k];
+                if (count_only) {
+                    std::ofstream f(dirs[k] / "drop_rates.txt");
+                    for (auto [mmsi, drop_rate] : result.drop_rates) {
+                        f << mmsi << ": " << drop_rate << '\n';
+                    }
+                }
+                if (not pack.empty()) {
+                    write_pack(dirs[k] / pack, result.seqs);
+                }
+
+                std::cout << k << ' ' << config.seq_length << ' ' << config.dt_max << ' '
+                          << config.ds_max << ' ' << config.dti << ' ' << config.v_min << ' '
+                          << result.n_sequences << ' ' << result.drop_rate() << '\n';
+            }
+        } else if (args.is_set("-S")) {
             if (v > 0.) {
                 std::cerr << "Error: Option -S is incompatible with v > 0.\n";
                 return 1;
             }
-            for (auto [mmsi, drop_rate] : SequenceCounter{split_args, d}.run(lpf)) {
+            for (auto [mmsi, drop_rate] : SequenceCounter{split_args, input_args}.run(lpf)) {
                 std::cout << mmsi << ": " << drop_rate << '\n';
             }
+        } else if (not pack.empty()) {
+            write_pack(p / pack, SequenceMaker{split_args, input_args}.run(lpf));
         } else {
-            for (auto [mmsi, seq] : SequenceMaker{split_args, d}.run(lpf)) {
-                dump_seq(mmsi, seq, p);
-            }
+            // sequences are written while further trajectories are processed
+            SequenceMaker{split_args, input_args}.run(
+                lpf, [&writer, &p, &format](ais::mmsi_t mmsi, std::span<const ais::Point> seq) {
+                    dump_seq(writer, mmsi, seq, p, *format);
+                });
+        }
+        {
+            const stats::Scope scope{stats::Stage::write};
+            writer.finish();
         }
     } catch (const std::invalid_argument& e) {
         std::cerr << e.what() << '\n';
         return 1;
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
     return 0;
@@ -1,108 +1,209 @@
 #include "sequencer.hpp"
 
 #include "io.hpp"
+#include "parse.hpp"
+#include "stats.hpp"
 #include "utility.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <limits>
-#include <optional>
-#include <stdexcept>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
 namespace seqmaker {
-Sequencer::Sequencer(split_args split_args, std::string_view delimiter)
-    : delimiter_(delimiter)
+namespace {
+// the number of files positions are spilled to if they exceed the memory budget
+constexpr std::size_t N_SPILL_PARTITIONS = 256;
+
+/*
+ * The maximal number of positions that are staged in memory, where staged positions are copied
+ * once while being grouped and about twice while being sorted.
+ */
+[[nodiscard]] std::size_t max_staged(std::size_t mem_limit) noexcept {
+    return mem_limit / (2 * sizeof(TrajectoryStore::Batch::value_type));
+}
+}   // namespace
+
+Sequencer::Sequencer(split_args split_args, input_args input_args)
+    : input_args_(input_args)
+    , delimiter_(input_args.delimiter)
     , split_args_(split_args) {
-    if (auto read_from_input_stream = not delimiter.empty(); read_from_input_stream) {
-        io::process_input_stream([this, delimiter](std::string_view line) {
-            auto process_ais_line = [](std::string_view t_str,
-                                       std::string_view mmsi_str,
-                                       std::string_view slot_str,
-                                       std::string_view lat_str,
-                                       std::string_view lon_str) {
-                auto any_empty = [](auto... x) { return (x.empty() || ...); };
-                if (any_empty(t_str, mmsi_str, slot_str, lat_str, lon_str)) {
-                    throw std::invalid_argument(
-                        "Invalid data format. At least one column is empty.");
-                }
-
-                constexpr auto pos_fallback = std::numeric_limits<ais::Point::value_type>::max();
-
-                const auto t = utility::time_recorded<ais::time_t>(t_str, slot_str);
-                const auto mmsi = utility::to<ais::mmsi_t>(mmsi_str, 0);
-                const auto lat = utility::to<ais::Point::value_type>(lat_str, pos_fallback);
-                const auto lon = utility::to<ais::Point::value_type>(lon_str, pos_fallback);
-
-                auto valid_pos = [](auto lat, auto lon) {
-                    constexpr auto MAX_LAT = ais::Point::MAX_LATITUDE;
-                    constexpr auto MAX_LON = ais::Point::MAX_LONGITUDE;
-                    constexpr auto MIN_LAT = ais::Point::MIN_LATITUDE;
-                    constexpr auto MIN_LON = ais::Point::MIN_LONGITUDE;
-                    static_assert(MAX_LAT < pos_fallback);
-                    static_assert(MAX_LON < pos_fallback);
-                    return MIN_LAT <= lat and lat <= MAX_LAT and MIN_LON <= lon and lon <= MAX_LON;
-                };
-
-                const auto is_valid = ais::is_valid_mmsi(mmsi) and t and valid_pos(lat, lon);
-                return is_valid ? std::optional{std::make_pair(
-                           mmsi,
-                           ais::Position{.t = *t,
-                                         .x = ais::Point{.latitude = lat, .longitude = lon}})}
-                                : std::nullopt;
-            };
-
-            const auto data = utility::split_map(line, delimiter, process_ais_line);
-            if (data) {
-                const auto [mmsi, trajectory] = *data;
-                auto it = this->trajectories_.find(mmsi);
-                if (it == this->trajectories_.end()) {
-                    it = this->trajectories_.try_emplace(mmsi, 0).first;
-                }
-
-                it->second.emplace_back(trajectory);
-            }
-        });
+    input_args_.n_threads = std::max(input_args_.n_threads, 1U);
+
+    if (not input_args_.cache.empty()) {
+        cache_ = std::make_shared<TrajectoryCache>(std::filesystem::path{input_args_.cache});
+    } else if (auto read_from_input_stream = not delimiter_.empty(); read_from_input_stream) {
+        // stage batches in input order, such that each trajectory keeps the order of the
+        // single-threaded ingestion
+        const stats::Scope scope{stats::Stage::input};
+        parse_ais_input(input_args_.files,
+                        delimiter_,
+                        input_args_.n_threads,
+                        [this](const TrajectoryStore::Batch& batch) { stage(batch); });
+    }
+}
+
+void Sequencer::stage(const TrajectoryStore::Batch& batch) {
+    if (spill_) {
+        spill_->append(batch);
+        return;
+    }
+
+    trajectories_.append(batch);
+    if (const auto mem_limit = input_args_.mem_limit;
+        mem_limit > 0 and trajectories_.n_staged() > max_staged(mem_limit)) {
+        spill_ = std::make_shared<SpillFiles>(N_SPILL_PARTITIONS);
+        for (auto& chunk : trajectories_.take_staged()) {
+            spill_->append(chunk);
+            chunk = TrajectoryStore::Batch{};
+        }
     }
 }
 
-void Sequencer::run(bool apply_low_pass_filter) noexcept {
-    init(trajectories_.size());
-    for (auto [mmsi, trajectory] : trajectories_) {
+void Sequencer::run_trajectory(unsigned worker,
+                               ais::mmsi_t mmsi,
+                               std::span<ais::Position> trajectory,
+                               bool is_sorted,
+                               bool apply_low_pass_filter) noexcept {
+    auto last = trajectory.end();
+    if (not is_sorted) {
         auto by_time = [](auto a, auto b) { return a.t < b.t; };
         std::sort(trajectory.begin(), trajectory.end(), by_time);
 
         auto time_eq = [](auto a, auto b) { return a.t == b.t; };
-        auto last = std::unique(trajectory.begin(), trajectory.end(), time_eq);
-        trajectory.erase(last, trajectory.end());
-
-        if (apply_low_pass_filter) {
-            auto is_valid = [ds_max = split_args_.ds_max](auto a, auto b) noexcept {
-                assert(a.t < b.t);     // NOLINT
-                assert(ds_max > 0.);   // NOLINT
-
-                // pieces are already ordered in time
-                return a.x.dist_nm(b.x) <= ds_max;
-            };
-            last = utility::low_pass_filter(trajectory.begin(),
-                                            trajectory.end(),
-                                            trajectory.begin(),
-                                            is_valid),
-            trajectory.erase(last, trajectory.end());
+        last = std::unique(trajectory.begin(), trajectory.end(), time_eq);
+    }
+
+    const auto n_unique = static_cast<std::size_t>(std::distance(trajectory.begin(), last));
+    auto n = n_unique;
+    if (apply_low_pass_filter) {
+        n = low_pass_filter(trajectory.first(n), split_args_);
+    }
+
+    const auto is_eligible = spans_sequence(trajectory.first(n), split_args_);
+    if (stats::enabled()) {
+        stats::add(stats::Counter::duplicates_removed, trajectory.size() - n_unique);
+        stats::add(stats::Counter::points_filtered, n_unique - n);
+        stats::add(is_eligible ? stats::Counter::trajectories_processed
+                               : stats::Counter::trajectories_skipped,
+                   1);
+    }
+
+    if (is_eligible) {
+        process(worker, mmsi, trajectory.first(n));
+    }
+}
+
+std::size_t Sequencer::low_pass_filter(std::span<ais::Position> trajectory,
+                                       const split_args& args) noexcept {
+    std::vector<double> ds(std::max<std::size_t>(trajectory.size(), 1) - 1);
+    ais::adjacent_dist(args.metric, trajectory, ds);
+
+    // pieces are already ordered in time, and ds[i] is the distance of the pair (i, i + 1)
+    auto is_valid = [&ds, ds_max = ais::from_nm(args.metric, args.ds_max)](std::size_t i) noexcept {
+        assert(ds_max > 0.);   // NOLINT
+        return ds[i] <= ds_max;
+    };
+    const auto last = utility::low_pass_filter_by_index(
+        trajectory.begin(), trajectory.end(), trajectory.begin(), is_valid);
+    return static_cast<std::size_t>(std::distance(trajectory.begin(), last));
+}
+
+bool Sequencer::spans_sequence(ais::TrajectoryView trajectory, const split_args& args) noexcept {
+    const auto n = trajectory.size();
+    const auto dt = args.seq_length * args.dti;
+    return n > 0 and n * args.dt_max >= dt and trajectory.back().t - trajectory.front().t >= dt;
+}
+
+void Sequencer::run(bool apply_low_pass_filter) {
+    if (cache_) {
+        run_trajectories(*cache_, apply_low_pass_filter);
+        return;
+    }
+
+    if (not spill_) {
+        run_trajectories(apply_low_pass_filter);
+        return;
+    }
+
+    spill_->flush();
+
+    const auto n_partitions = spill_->n_partitions();
+    const auto budget = max_staged(input_args_.mem_limit);
+    for (std::size_t first = 0; first < n_partitions;) {
+        auto n = spill_->size(first);
+        auto last = first + 1;
+        for (; last < n_partitions and n + spill_->size(last) <= budget; last++) {
+            n += spill_->size(last);
         }
 
-        const auto dt = split_args_.seq_length * split_args_.dti;
-        if (auto n = trajectory.size(); n > 0 and n * split_args_.dt_max >= dt) {
-            auto t_min = trajectory.front().t;
-            auto t_max = trajectory.back().t;
-            if (t_max - t_min >= dt) {
-                process(mmsi, trajectory);
-            }
+        for (auto i = first; i < last; i++) {
+            spill_->load(i, trajectories_);
+        }
+        run_trajectories(apply_low_pass_filter);
+
+        trajectories_ = TrajectoryStore{};
+        first = last;
+    }
+    spill_.reset();
+}
+
+void Sequencer::run_trajectories(bool apply_low_pass_filter) {
+    {
+        const stats::Scope scope{stats::Stage::group};
+        if (input_args_.radix_sort) {
+            trajectories_.sort(input_args_.n_threads);
+        } else {
+            trajectories_.group();
         }
     }
+    run_trajectories(trajectories_, apply_low_pass_filter);
 }
 
-void Sequencer::add_trajectory(ais::mmsi_t mmsi, const ais::Trajectory& trajectory) noexcept {
-    trajectories_.insert_or_assign(mmsi, trajectory);
+template <typename Store>
+void Sequencer::run_trajectories(Store& trajectories, bool apply_low_pass_filter) {
+    const stats::Scope scope{stats::Stage::process};
+
+    const auto n_threads = input_args_.n_threads;
+    std::vector<std::size_t> tasks(trajectories.size());
+    std::iota(tasks.begin(), tasks.end(), 0);
+
+    const auto n_workers = static_cast<unsigned>(std::min<std::size_t>(n_threads, tasks.size()));
+    if (in_mmsi_order_) {
+        std::sort(tasks.begin(), tasks.end(), [&trajectories](auto a, auto b) {
+            return trajectories.mmsi(a) < trajectories.mmsi(b);
+        });
+    } else if (n_workers > 1) {
+        // hand out the longest trajectories first such that no worker is left with a long
+        // trajectory at the end while the others are idle
+        std::sort(tasks.begin(), tasks.end(), [&trajectories](auto a, auto b) {
+            const auto n_a = trajectories.trajectory(a).size();
+            const auto n_b = trajectories.trajectory(b).size();
+            return n_a > n_b or (n_a == n_b and a < b);
+        });
+    }
+
+    init(tasks.size(), n_threads);
+    utility::parallel_for(tasks.size(), n_workers, [&](unsigned worker, std::size_t i) {
+        run_trajectory(worker,
+                       trajectories.mmsi(tasks[i]),
+                       trajectories.trajectory(tasks[i]),
+                       trajectories.is_sorted(),
+                       apply_low_pass_filter);
+        complete(worker, i);
+    });
+}
+
+void Sequencer::add_trajectory(ais::mmsi_t mmsi, ais::TrajectoryView trajectory) {
+    TrajectoryStore::Batch batch;
+    batch.reserve(trajectory.size());
+    for (auto position : trajectory) {
+        batch.emplace_back(mmsi, position);
+    }
+    stage(batch);
 }
-}   // namespace seqmaker
\ No newline at end of file
+}   // namespace seqmaker
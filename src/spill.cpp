@@ -0,0 +1,147 @@
+#include "spill.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <stdlib.h>
+
+namespace seqmaker {
+namespace {
+    [[nodiscard]] std::filesystem::path make_temp_directory() {
+        auto dir = (std::filesystem::temp_directory_path() / "seqmaker-XXXXXX").string();
+        if (::mkdtemp(dir.data()) == nullptr) {
+            throw std::system_error(errno, std::generic_category(), dir);
+        }
+        return dir;
+    }
+
+    using Record = std::array<char, SpillFiles::RECORD_SIZE>;
+
+    [[nodiscard]] Record encode(ais::mmsi_t mmsi, ais::Position position) noexcept {
+        constexpr auto N = sizeof(std::int32_t);
+        static_assert(sizeof(mmsi) == N and sizeof(position.t) == N
+                      and sizeof(ais::Point::value_type) == N);
+
+        Record bytes;   // NOLINT
+        std::memcpy(&bytes[0], &mmsi, N);
+        std::memcpy(&bytes[N], &(position.t), N);
+        std::memcpy(&bytes[2 * N], &(position.x.latitude), N);
+        std::memcpy(&bytes[3 * N], &(position.x.longitude), N);
+        return bytes;
+    }
+
+    [[nodiscard]] std::pair<ais::mmsi_t, ais::Position> decode(const char* bytes) noexcept {
+        constexpr auto N = sizeof(std::int32_t);
+
+        std::pair<ais::mmsi_t, ais::Position> record{};
+        std::memcpy(&(record.first), bytes, N);
+        std::memcpy(&(record.second.t), bytes + N, N);                 // NOLINT
+        std::memcpy(&(record.second.x.latitude), bytes + 2 * N, N);    // NOLINT
+        std::memcpy(&(record.second.x.longitude), bytes + 3 * N, N);   // NOLINT
+        return record;
+    }
+}   // namespace
+
+SpillFiles::SpillFiles(std::size_t n_partitions)
+    : dir_(make_temp_directory())
+    , buffers_(n_partitions)
+    , sizes_(n_partitions, 0) {
+    try {
+        files_.reserve(n_partitions);
+        for (std::size_t i = 0; i < n_partitions; i++) {
+            if (not files_.emplace_back(path(i), std::ios::binary)) {
+                throw std::system_error(errno, std::generic_category(), path(i).string());
+            }
+            buffers_[i].reserve(BUFFER_SIZE * RECORD_SIZE);
+        }
+    } catch (...) {
+        files_.clear();
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+        throw;
+    }
+}
+
+SpillFiles::~SpillFiles() {
+    files_.clear();
+    std::error_code ec;
+    std::filesystem::remove_all(dir_, ec);
+}
+
+std::filesystem::path SpillFiles::path(std::size_t partition) const {
+    return dir_ / (std::to_string(partition) + ".bin");
+}
+
+std::size_t SpillFiles::partition(ais::mmsi_t mmsi) const noexcept {
+    // Fibonacci hashing, the upper bits of the product are mapped onto the partitions
+    constexpr std::uint32_t MULTIPLIER = 2654435769U;
+    const auto h = static_cast<std::uint32_t>(mmsi) * MULTIPLIER;
+
+    constexpr auto N_HASH_BITS = 32U;
+    return (std::uint64_t{h} * sizes_.size()) >> N_HASH_BITS;
+}
+
+void SpillFiles::write(std::size_t partition) {
+    auto& buffer = buffers_[partition];
+    if (not files_[partition].write(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+        throw std::system_error(errno, std::generic_category(), path(partition).string());
+    }
+    buffer.clear();
+}
+
+void SpillFiles::append(const TrajectoryStore::Batch& batch) {
+    for (const auto& [mmsi, position] : batch) {
+        const auto i = partition(mmsi);
+        const auto bytes = encode(mmsi, position);
+
+        auto& buffer = buffers_[i];
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        sizes_[i]++;
+
+        if (buffer.size() == BUFFER_SIZE * RECORD_SIZE) {
+            write(i);
+        }
+    }
+}
+
+void SpillFiles::flush() {
+    for (std::size_t i = 0; i < n_partitions(); i++) {
+        write(i);
+        if (not files_[i].flush()) {
+            throw std::system_error(errno, std::generic_category(), path(i).string());
+        }
+    }
+}
+
+void SpillFiles::load(std::size_t partition, TrajectoryStore& store) const {
+    std::ifstream f(path(partition), std::ios::binary);
+    if (not f) {
+        throw std::system_error(errno, std::generic_category(), path(partition).string());
+    }
+
+    // read in chunks of 1 MiB
+    constexpr std::size_t CHUNK_SIZE = 1U << 16U;
+    std::vector<char> bytes(CHUNK_SIZE * RECORD_SIZE);
+    TrajectoryStore::Batch batch;
+    batch.reserve(CHUNK_SIZE);
+
+    for (auto n = sizes_[partition]; n > 0;) {
+        const auto n_chunk = std::min(n, CHUNK_SIZE);
+        if (not f.read(bytes.data(), static_cast<std::streamsize>(n_chunk * RECORD_SIZE))) {
+            throw std::system_error(errno, std::generic_category(), path(partition).string());
+        }
+
+        batch.clear();
+        for (std::size_t i = 0; i < n_chunk; i++) {
+            batch.emplace_back(decode(&bytes[i * RECORD_SIZE]));
+        }
+        store.append(batch);
+        n -= n_chunk;
+    }
+}
+}   // namespace seqmaker
@@ -0,0 +1,173 @@
+#include "stats.hpp"
+
+#include <sys/resource.h>
+
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <system_error>
+
+namespace seqmaker::stats {
+namespace {
+    [[nodiscard]] std::uint64_t wall_ns() noexcept {
+        const auto t = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+    }
+
+    [[nodiscard]] std::uint64_t cpu_ns(Clock clock) noexcept {
+        timespec t{};
+        const auto id = clock == Clock::thread ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID;
+        if (clock_gettime(id, &t) != 0) {
+            return 0;
+        }
+
+        constexpr std::uint64_t NS = 1000000000;
+        return static_cast<std::uint64_t>(t.tv_sec) * NS + static_cast<std::uint64_t>(t.tv_nsec);
+    }
+
+    [[nodiscard]] double seconds(const std::atomic<std::uint64_t>& ns) noexcept {
+        constexpr double NS = 1e9;
+        return static_cast<double>(ns.load(std::memory_order_relaxed)) / NS;
+    }
+
+    [[nodiscard]] detail::Times& times(Stage stage) noexcept {
+        return detail::times[static_cast<std::size_t>(stage)];
+    }
+}   // namespace
+
+std::string_view to_string(Counter counter) noexcept {
+    switch (counter) {
+    case Counter::bytes_read:
+        return "bytes_read";
+    case Counter::rows_parsed:
+        return "rows_parsed";
+    case Counter::rows_rejected_missing_column:
+        return "rows_rejected_missing_column";
+    case Counter::rows_rejected_time:
+        return "rows_rejected_time";
+    case Counter::rows_rejected_mmsi:
+        return "rows_rejected_mmsi";
+    case Counter::rows_rejected_slot:
+        return "rows_rejected_slot";
+    case Counter::rows_rejected_position:
+        return "rows_rejected_position";
+    case Counter::duplicates_removed:
+        return "duplicates_removed";
+    case Counter::points_filtered:
+        return "points_filtered";
+    case Counter::positions_dropped:
+        return "positions_dropped";
+    case Counter::trajectories_processed:
+        return "trajectories_processed";
+    case Counter::trajectories_skipped:
+        return "trajectories_skipped";
+    case Counter::sequences_emitted:
+        return "sequences_emitted";
+    case Counter::sequences_rejected_v_min:
+        return "sequences_rejected_v_min";
+    case Counter::bytes_written:
+        return "bytes_written";
+    case Counter::n_counters:
+        break;
+    }
+    return "";
+}
+
+std::string_view to_string(Stage stage) noexcept {
+    switch (stage) {
+    case Stage::input:
+        return "input";
+    case Stage::parse:
+        return "parse";
+    case Stage::group:
+        return "group";
+    case Stage::process:
+        return "process";
+    case Stage::split:
+        return "split";
+    case Stage::dump:
+        return "dump";
+    case Stage::write:
+        return "write";
+    case Stage::n_stages:
+        break;
+    }
+    return "";
+}
+
+void enable() noexcept {
+    detail::enabled = true;
+}
+
+void disable() noexcept {
+    detail::enabled = false;
+}
+
+std::uint64_t get(Counter counter) noexcept {
+    return detail::counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+void reset() noexcept {
+    for (auto& counter : detail::counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& t : detail::times) {
+        t.wall_ns.store(0, std::memory_order_relaxed);
+        t.cpu_ns.store(0, std::memory_order_relaxed);
+        t.calls.store(0, std::memory_order_relaxed);
+    }
+}
+
+Scope::Scope(Stage stage, Clock clock) noexcept
+    : stage_(stage)
+    , clock_(clock)
+    , active_(enabled()) {
+    if (active_) {
+        wall_ns_ = wall_ns();
+        cpu_ns_ = cpu_ns(clock_);
+    }
+}
+
+Scope::~Scope() {
+    if (active_) {
+        auto& t = times(stage_);
+        t.wall_ns.fetch_add(wall_ns() - wall_ns_, std::memory_order_relaxed);
+        t.cpu_ns.fetch_add(cpu_ns(clock_) - cpu_ns_, std::memory_order_relaxed);
+        t.calls.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void write_json(const std::filesystem::path& path) {
+    std::ofstream f(path, std::ios::trunc);
+    if (not f) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+
+    f << "{\n  \"stages\": {";
+    for (std::size_t i = 0; i < detail::times.size(); i++) {
+        const auto stage = static_cast<Stage>(i);
+        const auto& t = times(stage);
+
+        f << (i == 0 ? "\n" : ",\n") << "    \"" << to_string(stage) << "\": {\"wall_s\": "
+          << seconds(t.wall_ns) << ", \"cpu_s\": " << seconds(t.cpu_ns)
+          << ", \"calls\": " << t.calls.load(std::memory_order_relaxed) << '}';
+    }
+
+    f << "\n  },\n  \"counters\": {";
+    for (std::size_t i = 0; i < detail::counters.size(); i++) {
+        const auto counter = static_cast<Counter>(i);
+        f << (i == 0 ? "\n" : ",\n") << "    \"" << to_string(counter) << "\": " << get(counter);
+    }
+
+    // ru_maxrss is given in kilobytes on Linux
+    rusage usage{};
+    const auto rss = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    f << "\n  },\n  \"peak_rss_bytes\": " << rss * 1024 << "\n}\n";
+
+    if (not f.flush()) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+}
+}   // namespace seqmaker::stats
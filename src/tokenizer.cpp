@@ -0,0 +1,201 @@
+#include "tokenizer.hpp"
+
+#include "intrinsics.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace seqmaker::io {
+namespace {
+    constexpr std::size_t CHUNK_SIZE = 64;
+
+    struct Masks {
+        std::uint64_t delimiter;
+        std::uint64_t newline;
+    };
+
+    /*
+     * Classifies the 64 bytes at p, where bit i of each mask refers to p[i]. If SINGLE is set,
+     * only the first character of the delimiter is considered.
+     */
+    template <bool SINGLE>
+    [[nodiscard]] Masks
+    classify(const char* p,
+             std::string_view delimiter,
+             [[maybe_unused]] const std::array<bool, 256>& is_delimiter) noexcept {
+#if defined(__AVX512BW__)
+        const auto x = _mm512_loadu_si512(p);
+        std::uint64_t d = 0;
+        if constexpr (SINGLE) {
+            d = _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(delimiter.front()));
+        } else {
+            for (auto c : delimiter) {
+                d |= _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(c));
+            }
+        }
+        return Masks{.delimiter = d, .newline = _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('\n'))};
+#elif defined(__AVX2__)
+        auto movemask = [](__m256i m) {
+            return std::uint64_t{static_cast<std::uint32_t>(_mm256_movemask_epi8(m))};
+        };
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));        // NOLINT
+        const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));   // NOLINT
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto match = [&lo, &hi, &movemask](char c) {
+            const auto v = _mm256_set1_epi8(c);
+            return movemask(_mm256_cmpeq_epi8(lo, v)) | movemask(_mm256_cmpeq_epi8(hi, v)) << 32U;
+        };
+
+        std::uint64_t d = 0;
+        if constexpr (SINGLE) {
+            d = match(delimiter.front());
+        } else {
+            for (auto c : delimiter) {
+                d |= match(c);
+            }
+        }
+        return Masks{.delimiter = d, .newline = match('\n')};
+#else
+        Masks masks{.delimiter = 0, .newline = 0};
+        for (std::size_t i = 0; i < CHUNK_SIZE; i++) {
+            const auto c = p[i];   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const auto is_d = SINGLE ? c == delimiter.front()
+                                     : is_delimiter[static_cast<unsigned char>(c)];
+            masks.delimiter |= std::uint64_t{is_d} << i;
+            masks.newline |= std::uint64_t{c == '\n'} << i;
+        }
+        return masks;
+#endif
+    }
+
+    template <bool SINGLE>
+    std::size_t scan(std::string_view block,
+                     std::string_view delimiter,
+                     const std::array<bool, 256>& is_delimiter,
+                     std::size_t n_columns,
+                     std::vector<std::string_view>& tokens) {
+        std::size_t n_lines = 0;
+
+        // state of the current line
+        std::size_t line_begin = 0;
+        std::size_t count = 0;   // number of columns so far
+        std::size_t token_begin = 0;
+        std::size_t token_end = std::string_view::npos;   // end of the last column
+        bool in_token = false;
+
+        auto end_token = [&](std::size_t pos) {
+            if (count < n_columns) {
+                tokens.emplace_back(block.substr(token_begin, pos - token_begin));
+            }
+            count++;
+            token_end = pos;
+            in_token = false;
+        };
+
+        auto end_line = [&](std::size_t pos) {
+            // a trailing carriage return is not part of the last column, cf. strip_cr
+            if (count <= n_columns and token_end == pos and block[pos - 1] == '\r') {
+                if (token_begin == pos - 1) {
+                    count--;
+                    tokens.resize(tokens.size() - (count < n_columns ? 1 : 0));
+                } else {
+                    tokens.back().remove_suffix(1);
+                }
+            }
+
+            if (count < n_columns) {
+                stats::add(stats::Counter::rows_rejected_missing_column, 1);
+                throw std::invalid_argument("Invalid data format. Could not find enough columns.");
+            }
+
+            n_lines++;
+            line_begin = pos + 1;
+            count = 0;
+            token_end = std::string_view::npos;
+            in_token = false;
+        };
+
+        // the start of the block behaves like a preceding boundary
+        std::uint64_t carry = 1;
+        std::array<char, CHUNK_SIZE> tail{};
+        for (std::size_t base = 0; base < block.size(); base += CHUNK_SIZE) {
+            const auto n = std::min(CHUNK_SIZE, block.size() - base);
+            const auto* p = &block[base];
+            if (n < CHUNK_SIZE) {
+                std::memcpy(tail.data(), p, n);
+                std::memset(&tail[n], '\n', CHUNK_SIZE - n);
+                p = tail.data();
+            }
+            const auto valid = n < CHUNK_SIZE ? (std::uint64_t{1} << n) - 1 : ~std::uint64_t{0};
+
+            const auto [d, nl] = classify<SINGLE>(p, delimiter, is_delimiter);
+            const auto boundary = d | nl;
+            const auto prev = boundary << 1U | carry;
+            carry = boundary >> (CHUNK_SIZE - 1);
+
+            const auto starts = ~boundary & prev;
+            const auto ends = boundary & ~prev & valid;
+            const auto newlines = nl & valid;
+
+            // columns beyond n_columns are skipped until the end of the line
+            auto events = count > n_columns ? newlines : (starts | ends | newlines);
+            while (events != 0) {
+                const auto bit = static_cast<unsigned>(std::countr_zero(events));
+                const auto pos = base + bit;
+                const auto mask = std::uint64_t{1} << bit;
+                events &= events - 1;
+
+                if ((starts & mask) != 0) {
+                    token_begin = pos;
+                    in_token = true;
+                } else {
+                    if ((ends & mask) != 0 and in_token) {
+                        end_token(pos);
+                    }
+
+                    if ((newlines & mask) != 0) {
+                        end_line(pos);
+                        // restore the events of the next line in case columns were skipped
+                        events = (starts | ends | newlines) & ~(mask | (mask - 1));
+                        continue;
+                    }
+                }
+
+                if (count > n_columns) {
+                    events &= newlines;
+                }
+            }
+        }
+
+        if (line_begin < block.size()) {
+            if (in_token) {
+                end_token(block.size());
+            }
+            end_line(block.size());
+        }
+
+        return n_lines;
+    }
+}   // namespace
+
+Tokenizer::Tokenizer(std::string_view delimiter) noexcept : delimiter_(delimiter) {
+    for (auto c : delimiter) {
+        is_delimiter_[static_cast<unsigned char>(c)] = true;
+    }
+}
+
+std::size_t Tokenizer::tokenize(std::string_view block,
+                                std::size_t n_columns,
+                                std::vector<std::string_view>& tokens) const {
+    if (delimiter_.size() == 1) {
+        return scan<true>(block, delimiter_, is_delimiter_, n_columns, tokens);
+    }
+    return scan<false>(block, delimiter_, is_delimiter_, n_columns, tokens);
+}
+}   // namespace seqmaker::io
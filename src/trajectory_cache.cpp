@@ -0,0 +1,194 @@
+#include "trajectory_cache.hpp"
+
+#include "parse.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace seqmaker {
+namespace {
+    constexpr std::array<char, 8> MAGIC{'A', 'I', 'S', 'C', 'A', 'C', 'H', 'E'};
+
+    static_assert(std::is_trivially_copyable_v<ais::Position>
+                  and sizeof(ais::Position) == 3 * sizeof(std::int32_t));
+
+    struct Header {
+        std::array<char, 8> magic;      // NOLINT
+        std::uint32_t version;          // NOLINT
+        std::uint32_t record_size;      // NOLINT
+        std::uint64_t n_trajectories;   // NOLINT
+        std::uint64_t n_positions;      // NOLINT
+        std::uint64_t mmsis;            // NOLINT
+        std::uint64_t offsets;          // NOLINT
+        std::uint64_t positions;        // NOLINT
+        std::uint64_t size;             // NOLINT
+    };
+
+    /*
+     * The header of a cache of the current version with the given number of entries.
+     */
+    [[nodiscard]] constexpr Header layout(std::uint64_t n_trajectories,
+                                          std::uint64_t n_positions) noexcept {
+        const auto mmsis = io::align(sizeof(Header));
+        const auto offsets = io::align(mmsis + n_trajectories * sizeof(ais::mmsi_t));
+        const auto positions = io::align(offsets + (n_trajectories + 1) * sizeof(std::uint64_t));
+        return Header{.magic = MAGIC,
+                      .version = TrajectoryCache::VERSION,
+                      .record_size = sizeof(ais::Position),
+                      .n_trajectories = n_trajectories,
+                      .n_positions = n_positions,
+                      .mmsis = mmsis,
+                      .offsets = offsets,
+                      .positions = positions,
+                      .size = positions + n_positions * sizeof(ais::Position)};
+    }
+
+    [[nodiscard]] std::invalid_argument invalid_cache(const std::filesystem::path& path,
+                                                      std::string_view reason) {
+        return io::invalid_file("trajectory cache", path, reason);
+    }
+}   // namespace
+
+TrajectoryCache::TrajectoryCache(const std::filesystem::path& path)
+    : fd_(path)
+    , file_(fd_.get(),
+            std::max(io::file_size(fd_.get(), path), std::size_t{1}),
+            PROT_READ | PROT_WRITE,
+            MADV_WILLNEED) {
+    if (not file_) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+
+    const auto bytes = file_.view();
+    Header header{};
+    if (io::file_size(fd_.get(), path) < sizeof(header)) {
+        throw invalid_cache(path, "The file is too small.");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (header.magic != MAGIC) {
+        throw invalid_cache(path, "The file is no cache or was written with another byte order.");
+    }
+    if (header.version != VERSION) {
+        throw invalid_cache(path,
+                            "The cache has version " + std::to_string(header.version)
+                                + " instead of " + std::to_string(VERSION) + '.');
+    }
+
+    const auto expected = layout(header.n_trajectories, header.n_positions);
+    if (header.record_size != expected.record_size or header.mmsis != expected.mmsis
+        or header.offsets != expected.offsets or header.positions != expected.positions
+        or header.size != expected.size or header.size != bytes.size()) {
+        throw invalid_cache(path, "The layout of the file does not match its header.");
+    }
+
+    auto* data = file_.data();
+    mmsis_ = {reinterpret_cast<const ais::mmsi_t*>(data + header.mmsis),   // NOLINT
+              header.n_trajectories};
+    offsets_ = {reinterpret_cast<const std::uint64_t*>(data + header.offsets),   // NOLINT
+                header.n_trajectories + 1};
+    positions_ = {reinterpret_cast<ais::Position*>(data + header.positions),   // NOLINT
+                  header.n_positions};
+
+    // trajectories must not reach beyond the position column
+    if (offsets_.front() != 0 or offsets_.back() != header.n_positions
+        or not std::is_sorted(offsets_.begin(), offsets_.end())) {
+        throw invalid_cache(path, "The offsets of the trajectories are corrupted.");
+    }
+
+    // trajectories are found by a binary search
+    if (std::adjacent_find(mmsis_.begin(), mmsis_.end(), std::greater_equal{}) != mmsis_.end()) {
+        throw invalid_cache(path, "The MMSIs are not in ascending order.");
+    }
+}
+
+std::optional<std::size_t> TrajectoryCache::find(ais::mmsi_t mmsi) const noexcept {
+    const auto it = std::lower_bound(mmsis_.begin(), mmsis_.end(), mmsi);
+    if (it == mmsis_.end() or *it != mmsi) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - mmsis_.begin());
+}
+
+TrajectoryCache::Writer::Writer(std::filesystem::path path,
+                                std::span<const ais::mmsi_t> mmsis,
+                                std::span<const std::uint64_t> offsets)
+    : out_(std::move(path)) {
+    if (offsets.size() != mmsis.size() + 1 or offsets.front() != 0
+        or not std::is_sorted(offsets.begin(), offsets.end())) {
+        throw std::invalid_argument("Invalid offsets of trajectories to cache.");
+    }
+    if (std::adjacent_find(mmsis.begin(), mmsis.end(), std::greater_equal{}) != mmsis.end()) {
+        throw std::invalid_argument("Only trajectories in ascending order of MMSIs can be cached.");
+    }
+
+    const auto header = layout(mmsis.size(), offsets.back());
+    size_ = header.size;
+
+    out_.put(&header, sizeof(header));
+    out_.pad(header.mmsis);
+    out_.put(mmsis.data(), mmsis.size_bytes());
+    out_.pad(header.offsets);
+    out_.put(offsets.data(), offsets.size_bytes());
+    out_.pad(header.positions);
+}
+
+void TrajectoryCache::Writer::append(ais::TrajectoryView positions) {
+    if (out_.n_written() + positions.size_bytes() > size_) {
+        throw std::invalid_argument("More positions to cache than announced by the offsets.");
+    }
+    out_.put(positions.data(), positions.size_bytes());
+}
+
+void TrajectoryCache::Writer::close() {
+    if (out_.n_written() != size_) {
+        throw std::invalid_argument("Fewer positions to cache than announced by the offsets.");
+    }
+    out_.flush();
+}
+
+void TrajectoryCache::write(const std::filesystem::path& path, const TrajectoryStore& store) {
+    if (not store.is_sorted()) {
+        throw std::invalid_argument("Only sorted trajectories can be cached.");
+    }
+
+    std::vector<ais::mmsi_t> mmsis(store.size());
+    std::vector<std::uint64_t> offsets(store.size() + 1, 0);
+    for (std::size_t i = 0; i < store.size(); i++) {
+        mmsis[i] = store.mmsi(i);
+        offsets[i + 1] = offsets[i] + store.trajectory(i).size();
+    }
+
+    Writer writer{path, mmsis, offsets};
+    for (std::size_t i = 0; i < store.size(); i++) {
+        writer.append(store.trajectory(i));
+    }
+    writer.close();
+}
+
+void TrajectoryCache::build(const std::filesystem::path& path,
+                            std::string_view delimiter,
+                            unsigned n_threads,
+                            std::span<const std::string> files) {
+    n_threads = std::max(n_threads, 1U);
+
+    TrajectoryStore store;
+    parse_ais_input(files, delimiter, n_threads, [&store](const TrajectoryStore::Batch& batch) {
+        store.append(batch);
+    });
+    store.sort(n_threads);
+
+    write(path, store);
+}
+}   // namespace seqmaker
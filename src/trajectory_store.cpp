@@ -0,0 +1,154 @@
+#include "trajectory_store.hpp"
+
+#include "mmsi_map.hpp"
+#include "radix_sort.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+namespace seqmaker {
+void TrajectoryStore::append(const Batch& batch) {
+    for (auto first = batch.begin(); first != batch.end();) {
+        if (staged_.empty() or staged_.back().size() == STAGING_CHUNK_SIZE) {
+            staged_.emplace_back().reserve(STAGING_CHUNK_SIZE);
+        }
+
+        auto& chunk = staged_.back();
+        const auto n = std::min(static_cast<std::size_t>(std::distance(first, batch.end())),
+                                STAGING_CHUNK_SIZE - chunk.size());
+        const auto last = std::next(first, static_cast<std::ptrdiff_t>(n));
+        chunk.insert(chunk.end(), first, last);
+        first = last;
+    }
+}
+
+void TrajectoryStore::group() {
+    if (staged_.empty()) {
+        return;
+    }
+
+    MmsiMap<ais::mmsi_t> index{mmsis_.size()};
+
+    std::vector<ais::mmsi_t> mmsis;
+    std::vector<std::size_t> counts;
+    mmsis.reserve(mmsis_.size());
+    counts.reserve(mmsis_.size());
+
+    // i is the index of the trajectory in the map, which is assigned on insertion of the MMSI
+    auto count = [&mmsis, &counts](ais::mmsi_t mmsi, ais::mmsi_t& i, bool inserted, std::size_t n) {
+        if (inserted) {
+            i = static_cast<ais::mmsi_t>(mmsis.size());
+            mmsis.emplace_back(mmsi);
+            counts.emplace_back(0);
+        }
+        counts[static_cast<std::size_t>(i)] += n;
+    };
+
+    // already grouped trajectories keep their index and precede staged positions
+    for (std::size_t i = 0; i < mmsis_.size(); i++) {
+        auto [j, inserted] = index.find_or_insert(mmsis_[i]);
+        count(mmsis_[i], j, inserted, offsets_[i + 1] - offsets_[i]);
+    }
+
+    // replace the MMSI of each staged position by the index of its trajectory
+    for (auto& chunk : staged_) {
+        index.find_or_insert(
+            chunk,
+            [](const auto& record) { return record.first; },
+            [&count](auto& record, ais::mmsi_t& i, bool inserted) {
+                count(record.first, i, inserted, 1);
+                record.first = i;
+            });
+    }
+
+    std::vector<std::size_t> offsets(counts.size() + 1, 0);
+    std::partial_sum(counts.begin(), counts.end(), std::next(offsets.begin()));
+
+    decltype(positions_) positions(offsets.back());
+    std::vector<std::size_t> next(offsets.begin(), std::prev(offsets.end()));
+    for (std::size_t i = 0; i < mmsis_.size(); i++) {
+        const auto trajectory = std::as_const(*this).trajectory(i);
+        std::copy(trajectory.begin(),
+                  trajectory.end(),
+                  std::next(positions.begin(), static_cast<std::ptrdiff_t>(next[i])));
+        next[i] += trajectory.size();
+    }
+    positions_ = decltype(positions_){};
+
+    for (auto& chunk : staged_) {
+        for (auto [i, position] : chunk) {
+            positions[next[static_cast<std::size_t>(i)]++] = position;
+        }
+        chunk = Batch{};
+    }
+    staged_.clear();
+
+    positions_ = std::move(positions);
+    mmsis_ = std::move(mmsis);
+    offsets_ = std::move(offsets);
+    sorted_ = false;
+}
+
+void TrajectoryStore::sort(unsigned n_threads) {
+    if (staged_.empty() and sorted_) {
+        return;
+    }
+
+    using Record = Batch::value_type;
+    std::vector<Record, utility::default_init_allocator<Record>> records;
+    records.reserve(std::accumulate(staged_.begin(),
+                                    staged_.end(),
+                                    positions_.size(),
+                                    [](auto n, const auto& chunk) { return n + chunk.size(); }));
+
+    for (std::size_t i = 0; i < mmsis_.size(); i++) {
+        for (auto position : std::as_const(*this).trajectory(i)) {
+            records.emplace_back(mmsis_[i], position);
+        }
+    }
+    positions_ = decltype(positions_){};
+
+    for (auto& chunk : staged_) {
+        records.insert(records.end(), chunk.begin(), chunk.end());
+        chunk = Batch{};
+    }
+    staged_.clear();
+
+    auto key = [](const Record& record) {
+        constexpr auto N_TIME_BITS = 32U;
+        static_assert(sizeof(ais::time_t) * CHAR_BIT == N_TIME_BITS);
+        return static_cast<std::uint64_t>(static_cast<std::uint32_t>(record.first)) << N_TIME_BITS
+               | record.second.t;
+    };
+    utility::radix_sort(records, key, n_threads);
+
+    // positions with a common MMSI and time are adjacent, keep the first one of each
+    positions_.resize(records.size());
+    mmsis_.clear();
+    offsets_.clear();
+
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < records.size(); i++) {
+        if (i > 0 and key(records[i - 1]) == key(records[i])) {
+            continue;
+        }
+
+        const auto [mmsi, position] = records[i];
+        if (mmsis_.empty() or mmsis_.back() != mmsi) {
+            mmsis_.emplace_back(mmsi);
+            offsets_.emplace_back(n);
+        }
+        positions_[n++] = position;
+    }
+    offsets_.emplace_back(n);
+    positions_.resize(n);
+    sorted_ = true;
+
+    stats::add(stats::Counter::duplicates_removed, records.size() - n);
+}
+}   // namespace seqmaker
@@ -1,12 +1,58 @@
 #include "ais.hpp"
+#include "ais_gen.hpp"
+#include "argparse.hpp"
+#include "async_writer.hpp"
+#include "codec.hpp"
+#include "histogram.hpp"
+#include "io.hpp"
+#include "mmsi_counter.hpp"
+#include "mmsi_map.hpp"
+#include "pack_file.hpp"
+#include "parse.hpp"
+#include "radix_sort.hpp"
 #include "seq.hpp"
+#include "seq_counter.hpp"
+#include "seq_diff.hpp"
 #include "seq_maker.hpp"
+#include "seq_streamer.hpp"
+#include "seq_sweep.hpp"
+#include "stats.hpp"
+#include "tokenizer.hpp"
+#include "trajectory_cache.hpp"
+#include "trajectory_store.hpp"
 #include "utility.hpp"
 
+#include <algorithm>
 #include <catch2/catch.hpp>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+/*
+ * Path of a temporary file or directory that is unique to the test process, such that concurrent
+ * runs of the tests do not interfere.
+ */
+[[nodiscard]] std::filesystem::path temp_path(std::string_view name) {
+    return std::filesystem::temp_directory_path()
+           / ("seqmaker-test-" + std::to_string(::getpid()) + '-' + std::string{name});
+}
+}   // namespace
 
 TEST_CASE("Test distance measure", "[ais]") {
     using namespace seqmaker;
@@ -21,6 +67,101 @@ TEST_CASE("Test distance measure", "[ais]") {
     REQUIRE(p1.dist_nm(p2) == Approx{dist_exp});
 }
 
+TEST_CASE("Test batched distance measure", "[ais]") {
+    using namespace seqmaker;
+    std::mt19937 g(0);   // NOLINT
+    std::uniform_int_distribution<ais::Point::value_type> lat(ais::Point::MIN_LATITUDE,
+                                                              ais::Point::MAX_LATITUDE);
+    std::uniform_int_distribution<ais::Point::value_type> lon(ais::Point::MIN_LONGITUDE,
+                                                              ais::Point::MAX_LONGITUDE);
+    std::uniform_int_distribution<ais::Point::value_type> step(-5000, 5000);   // NOLINT
+
+    // sizes that are no multiple of the vector widths, neighbouring and arbitrary points
+    for (auto n : {0U, 1U, 2U, 7U, 8U, 13U, 100U}) {
+        for (auto far : {false, true}) {
+            ais::Trajectory trajectory;
+            std::vector<ais::Point> points;
+            auto x = ais::Point{.latitude = lat(g) / 2, .longitude = lon(g)};
+            for (auto i = 0U; i < n; i++) {
+                x = far ? ais::Point{.latitude = lat(g), .longitude = lon(g)}
+                        : ais::Point{.latitude = x.latitude + step(g),
+                                     .longitude = x.longitude + step(g)};
+                trajectory.emplace_back(ais::Position{.t = i, .x = x});
+                points.emplace_back(x);
+            }
+
+            for (auto stride : {1U, 3U}) {
+                const auto m = n > stride ? n - stride : 0U;
+                std::vector<double> d1(m);
+                std::vector<double> d2(m);
+                ais::adjacent_dist<ais::Equirectangular>(points, d1, stride);
+                ais::adjacent_dist<ais::Equirectangular>(trajectory, d2, stride);
+
+                for (auto i = 0U; i < m; i++) {
+                    const auto expected = points[i].dist_nm(points[i + stride]);
+                    REQUIRE(d1[i] == Approx{expected}.epsilon(1e-7).margin(1e-9));
+                    REQUIRE(d2[i] == d1[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Test distance metrics", "[ais]") {
+    using namespace seqmaker;
+    constexpr auto one_deg = 600000U;
+    constexpr ais::Point p1{.latitude = 52 * one_deg, .longitude = 13 * one_deg};
+    constexpr ais::Point p2{.latitude = 50 * one_deg, .longitude = 10 * one_deg};
+    constexpr ais::Point p3{.latitude = 52 * one_deg + 1000, .longitude = 13 * one_deg - 2000};
+
+    // spherical law of cosines on a sphere where a minute of arc is one nautical mile
+    constexpr auto PI = 3.14159265359;
+    auto rad = [PI](double deg) { return deg / 180. * PI; };
+    const auto angle = std::acos(std::sin(rad(52.)) * std::sin(rad(50.))
+                                 + std::cos(rad(52.)) * std::cos(rad(50.)) * std::cos(rad(3.)));
+    REQUIRE(ais::Haversine::dist(p1, p2) == Approx{angle / PI * 180. * 60.});
+    REQUIRE(ais::Haversine::dist(p1, p3) == Approx{p1.dist_nm(p3)}.epsilon(1e-4));
+
+    REQUIRE(ais::Flat::dist(p1, p2) == Approx{p1.dist_nm(p2) * p1.dist_nm(p2)});
+    REQUIRE(ais::Flat::to_nm(ais::Flat::from_nm(.5)) == Approx{.5});
+
+    const std::vector<ais::Point> points{p1, p3, p2, p1};
+    std::vector<double> d(points.size() - 1);
+    for (auto metric : {ais::Metric::equirectangular, ais::Metric::haversine, ais::Metric::flat}) {
+        REQUIRE(ais::to_metric(ais::to_string(metric)) == metric);
+
+        ais::with_metric(metric, [&](auto m) {
+            using M = decltype(m);
+            ais::adjacent_dist<M>(points, d);
+            for (std::size_t i = 0; i < d.size(); i++) {
+                REQUIRE(d[i] == Approx{M::dist(points[i], points[i + 1])}.epsilon(1e-7));
+            }
+
+            const auto acc_dist = p1.dist_nm(p3) + p3.dist_nm(p2) + p2.dist_nm(p1);
+            REQUIRE(ais::acc_dist_nm<M>(points) == Approx{acc_dist}.epsilon(1e-3));
+        });
+    }
+    REQUIRE(not ais::to_metric("euclidean"));
+
+    // the scalar distances are identical to the ones of the vector kernels and their remainder
+    std::mt19937 g(0);                                                             // NOLINT
+    std::uniform_int_distribution<ais::Point::value_type> x(-50000000, 50000000);   // NOLINT
+    std::vector<ais::Point> random_points(37);                                     // NOLINT
+    for (auto& p : random_points) {
+        p = ais::Point{.latitude = x(g), .longitude = x(g)};
+    }
+    std::vector<double> dr(random_points.size() - 1);
+    for (auto metric : {ais::Metric::equirectangular, ais::Metric::flat}) {
+        ais::with_metric(metric, [&](auto m) {
+            using M = decltype(m);
+            ais::adjacent_dist<M>(random_points, dr);
+            for (std::size_t i = 0; i < dr.size(); i++) {
+                REQUIRE(dr[i] == M::dist(random_points[i], random_points[i + 1]));
+            }
+        });
+    }
+}
+
 TEST_CASE("Test MMSI validator", "[ais]") {
     using namespace seqmaker::ais;
 
@@ -66,6 +207,79 @@ TEST_CASE("Test adjacent difference", "[utility]") {
     }
 }
 
+TEST_CASE("Test radix sort", "[utility]") {
+    using namespace seqmaker;
+    std::mt19937 g(0);                                                   // NOLINT
+    std::uniform_int_distribution<std::uint64_t> key(0, 1ULL << 40U);   // NOLINT
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> data;
+    for (std::size_t i = 0; i < 10000; i++) {   // NOLINT
+        data.emplace_back(key(g) & ~0xFF00ULL, i);
+        if (i % 7 == 0) {   // NOLINT
+            // same key, tells apart whether the order of equal keys is kept
+            data.emplace_back(data.back().first, data.size());
+        }
+    }
+
+    auto expected = data;
+    std::stable_sort(expected.begin(), expected.end(), [](auto a, auto b) {
+        return a.first < b.first;
+    });
+
+    for (auto n_threads : {1U, 3U}) {
+        auto sorted = data;
+        utility::radix_sort(sorted, [](auto x) { return x.first; }, n_threads);
+        REQUIRE(sorted == expected);
+    }
+}
+
+TEST_CASE("Test MMSI map", "[utility]") {
+    using namespace seqmaker;
+    std::mt19937 g(0);                                                        // NOLINT
+    std::uniform_int_distribution<ais::mmsi_t> mmsi(200000000, 200000999);   // NOLINT
+
+    std::vector<ais::mmsi_t> data(10000);   // NOLINT
+    std::generate(data.begin(), data.end(), [&] { return mmsi(g); });
+
+    std::unordered_map<ais::mmsi_t, std::size_t> expected;
+    for (auto x : data) {
+        expected[x]++;
+    }
+
+    SECTION("single lookups") {
+        MmsiMap<std::size_t> map;
+        REQUIRE(map.empty());
+        for (auto x : data) {
+            auto [n, inserted] = map.find_or_insert(x);
+            REQUIRE(inserted == (n == 0));
+            n++;
+        }
+        REQUIRE(map.size() == expected.size());
+
+        for (const auto& [x, n] : expected) {
+            REQUIRE(map.contains(x));
+            REQUIRE(*map.find(x) == n);
+        }
+        REQUIRE(not map.contains(100000000));   // NOLINT
+        REQUIRE(map.find(100000000) == nullptr);   // NOLINT
+    }
+
+    SECTION("batched lookups") {
+        MmsiMap<std::size_t> map{expected.size()};
+        std::size_t n_inserted = 0;
+        map.find_or_insert(
+            data, [](auto x) { return x; }, [&n_inserted](auto, std::size_t& n, bool inserted) {
+                n_inserted += inserted ? 1 : 0;
+                n++;
+            });
+        REQUIRE(n_inserted == expected.size());
+
+        std::unordered_map<ais::mmsi_t, std::size_t> counts;
+        map.for_each([&counts](ais::mmsi_t x, std::size_t n) { counts.emplace(x, n); });
+        REQUIRE(counts == expected);
+    }
+}
+
 TEST_CASE("Test estimation of recorded time", "[utility]") {
     const std::string T1{"123.4"};   // min 2, sec 3, msec 400
     const std::string T2{"173.6"};   // min 2, sec 53, msec 600
@@ -96,6 +310,652 @@ TEST_CASE("Test estimation of recorded time", "[utility]") {
     REQUIRE(t24 == 175);
 }
 
+TEST_CASE("Test integer decoding", "[utility]") {
+    using namespace seqmaker;
+    const std::vector<std::string> strings{"",
+                                           "-",
+                                           "+1",
+                                           "0",
+                                           "-0",
+                                           "42",
+                                           "1456786800.005",
+                                           "212345678",
+                                           " 212345678",
+                                           "-108000000",
+                                           "2147483647",
+                                           "2147483648",
+                                           "-2147483648",
+                                           "-2147483649",
+                                           "4294967295",
+                                           "4294967296",
+                                           "000000000000001",
+                                           "0000000000000001",
+                                           "-0000000000000042",
+                                           "0000000000000042x",
+                                           "00000000000000042",
+                                           "1234567890123456",
+                                           "00000000000000000000042x",
+                                           "123456789012345",
+                                           "12a34",
+                                           "--5"};
+    // decodes the string once in place and once followed by enough readable bytes for word loads
+    auto require_decoded = [](const std::string& str, auto fallback) {
+        using T = decltype(fallback);
+        const auto expected = utility::to<T>(str, fallback);
+        REQUIRE(utility::to_integer<T>(str, fallback) == expected);
+
+        const auto padded = str + ", 9876543210987654321";
+        const std::string_view view{padded.data(), str.size()};
+        REQUIRE(utility::to_integer<T>(view, fallback, padded.size()) == expected);
+    };
+
+    for (const auto& str : strings) {
+        require_decoded(str, std::int32_t{-7});
+        require_decoded(str, std::uint32_t{7});
+    }
+
+    std::mt19937 g(0);   // NOLINT
+    std::uniform_int_distribution<std::int64_t> value(-5000000000, 5000000000);   // NOLINT
+    for (auto i = 0; i < 10000; i++) {                                           // NOLINT
+        const auto str = std::to_string(value(g)) + (i % 2 == 0 ? "" : ".5");
+        require_decoded(str, std::int32_t{0});
+        require_decoded(str, std::uint32_t{0});
+    }
+}
+
+TEST_CASE("Test floating point decoding", "[utility]") {
+    using namespace seqmaker;
+    REQUIRE(utility::to<double>("0.5", -1.) == 0.5);
+    REQUIRE(utility::to<double>(".5", -1.) == 0.5);
+    REQUIRE(utility::to<double>("-2e3", -1.) == -2000.);
+    REQUIRE(utility::to<double>("1", -1.) == 1.);
+    REQUIRE(std::isinf(utility::to<double>("inf", -1.)));
+    REQUIRE(utility::to<double>("", -1.) == -1.);
+    REQUIRE(utility::to<double>("x", -1.) == -1.);
+    REQUIRE(utility::to<double>("0.5x", -1.) == -1.);
+    REQUIRE(utility::to<double>("1e999", -1.) == -1.);
+
+    // the string need not be terminated
+    constexpr std::string_view str{"0.25,1"};
+    REQUIRE(utility::to<double>(str.substr(0, 4), -1.) == 0.25);
+}
+
+TEST_CASE("Test batched parsing of AIS lines", "[io]") {
+    using namespace seqmaker;
+    const std::string lines{"1456804265.529, 468087407, 4, 22652851, -52369144, extra\n"
+                            "1456794144.788, 657398930, 24, 20930020, 42361779\n"
+                            "1456831639.506, 148295021, 18, 15122070, 13705075\n"
+                            "1456831639.506, 248295021, 60, 15122070, 13705075\n"
+                            "1456831639.506, 248295021, 18, 150000000, 13705075\n"
+                            "1456831639.506, 248295021, -3, -15122070, 13705075\n"
+                            "0.5, 248295021, 18, 15122070, 13705075\n"
+                            "abc, 248295021, 18, 15122070, 13705075\r\n"
+                            "1456831639, 248295021, 0, 15122070, 13705075\r\n"};
+
+    std::vector<std::pair<ais::mmsi_t, ais::Position>> expected;
+    auto f = [&expected](std::string_view line) {
+        if (auto data = parse_ais_line(line, ", "); data) {
+            expected.emplace_back(*data);
+        }
+    };
+    io::detail::for_each_line(lines, f);
+    REQUIRE(expected.size() == 4);
+
+    const auto batch = parse_ais_lines(lines, ", ");
+    REQUIRE(batch.size() == expected.size());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        REQUIRE(batch[i].first == expected[i].first);
+        REQUIRE(batch[i].second.t == expected[i].second.t);
+        REQUIRE(batch[i].second.x.latitude == expected[i].second.x.latitude);
+        REQUIRE(batch[i].second.x.longitude == expected[i].second.x.longitude);
+    }
+
+    REQUIRE_THROWS_AS(parse_ais_lines("1456804265.529, 468087407, 4, 22652851\n", ", "),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Test line splitting of input blocks", "[io]") {
+    using namespace seqmaker;
+    auto lines = [](std::string_view block) {
+        std::vector<std::string> v;
+        auto f = [&v](std::string_view line) { v.emplace_back(line); };
+        io::detail::for_each_line(block, f);
+        return v;
+    };
+
+    REQUIRE(lines("a,b\nc,d\n") == std::vector<std::string>{"a,b", "c,d"});
+    REQUIRE(lines("a,b\nc,d") == std::vector<std::string>{"a,b", "c,d"});
+    REQUIRE(lines("a,b\r\nc,d\r\n") == std::vector<std::string>{"a,b", "c,d"});
+    REQUIRE(lines("a,b\r\nc,d\r") == std::vector<std::string>{"a,b", "c,d"});
+    REQUIRE(lines("a,b\n\nc,d\n") == std::vector<std::string>{"a,b", "", "c,d"});
+    REQUIRE(lines("").empty());
+}
+
+TEST_CASE("Test splitting of input blocks into chunks", "[io]") {
+    using namespace seqmaker;
+    const std::string_view block{"aaaa\nbb\ncccccc\nd\neeeee\nf"};
+
+    for (auto n = 1U; n < 8U; n++) {
+        const auto chunks = io::split_block(block, n);
+        REQUIRE(not chunks.empty());
+        REQUIRE(chunks.size() <= n);
+
+        std::string joined;
+        for (auto chunk : chunks) {
+            REQUIRE(not chunk.empty());
+            if (chunk.data() + chunk.size() != block.data() + block.size()) {
+                REQUIRE(chunk.back() == '\n');
+            }
+            joined += chunk;
+        }
+        REQUIRE(joined == block);
+    }
+}
+
+TEST_CASE("Test reading input blocks from the current offset", "[io]") {
+    using namespace seqmaker;
+    const auto path = temp_path("offset.csv");
+
+    // lines across several pages
+    std::string content;
+    for (auto i = 0; i < 1000; i++) {   // NOLINT
+        content += std::to_string(1456790400 + i) + ",200000000,0,0\n";
+    }
+    std::ofstream{path} << content;
+
+    const auto second_page = content.find('\n', 4096) + 1;
+    for (auto pos : {std::size_t{0}, content.find('\n') + 1, second_page, content.size()}) {
+        const io::detail::FileDescriptor fd{path};
+        REQUIRE(::lseek(fd.get(), static_cast<off_t>(pos), SEEK_SET) == static_cast<off_t>(pos));
+
+        std::string read;
+        io::process_input_blocks(
+            fd.get(), [&read](std::string_view block) { read += block; }, 512);   // NOLINT
+        REQUIRE(read == content.substr(pos));
+        REQUIRE(::lseek(fd.get(), 0, SEEK_CUR) == static_cast<off_t>(content.size()));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Test parsing of input files", "[io]") {
+    using namespace seqmaker;
+    const auto dir = temp_path("input");
+    std::filesystem::create_directory(dir);
+
+    // lines of several vessels with a common time, such that the input order matters
+    std::string all_lines;
+    for (auto k = 0; k < 4; k++) {
+        std::string lines;
+        for (auto i = 0; i < 100; i++) {   // NOLINT
+            lines += std::to_string(1456790400 + i / 3) + ", " + std::to_string(200000000 + i % 7)
+                     + ", 0, " + std::to_string(k * 1000 + i) + ", 0\n";
+        }
+        std::ofstream{dir / ("day" + std::to_string(k) + ".csv")} << lines;
+        all_lines += lines;
+    }
+    std::ofstream{dir / "other.txt"} << "1456790400, 200000000, 0, 0\n";
+
+    const auto files = io::glob((dir / "day*.csv").string());
+    REQUIRE(files.size() == 4);
+    REQUIRE(std::is_sorted(files.begin(), files.end()));
+    REQUIRE(io::glob((dir / "day0.csv").string() + ",," + (dir / "day[12].csv").string()).size()
+            == 3);
+    const auto no_match = (dir / "none*.csv").string();
+    REQUIRE_THROWS_AS(io::glob(no_match), std::system_error);
+
+    // names with commas are matched by patterns instead
+    std::ofstream{dir / "day,4.csv"} << "";
+    REQUIRE(io::glob((dir / "day?4.csv").string())
+            == std::vector<std::string>{(dir / "day,4.csv").string()});
+    std::filesystem::remove(dir / "day,4.csv");
+
+    const auto expected = parse_ais_lines(all_lines, ", ");
+    REQUIRE(expected.size() == 400);
+    for (auto n_threads : {1U, 2U, 4U, 8U}) {
+        TrajectoryStore::Batch batch;
+        parse_ais_input(files, ", ", n_threads, [&batch](const TrajectoryStore::Batch& b) {
+            batch.insert(batch.end(), b.begin(), b.end());
+        });
+
+        REQUIRE(batch.size() == expected.size());
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            REQUIRE(batch[i].first == expected[i].first);
+            REQUIRE(batch[i].second.t == expected[i].second.t);
+            REQUIRE(batch[i].second.x.latitude == expected[i].second.x.latitude);
+        }
+    }
+
+    // errors of any file are passed on, also if later files are parsed concurrently
+    auto invalid = files;
+    invalid.insert(invalid.begin() + 1, (dir / "other.txt").string());
+    auto ignore = [](const TrajectoryStore::Batch& /* batch */) {};
+    for (auto n_threads : {1U, 2U, 5U}) {
+        REQUIRE_THROWS_AS(parse_ais_input(invalid, ", ", n_threads, ignore),
+                          std::invalid_argument);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test repeated arguments", "[io]") {
+    std::vector<const char*> argv{"seqmaker", "--input", "a.csv", "-j", "2", "--input", "b.csv"};
+    const argparse::Argparse args(static_cast<int>(argv.size()), argv.data());
+
+    REQUIRE(args.get("--input") == "b.csv");
+    REQUIRE(args.get_all("--input") == std::vector<std::string>{"a.csv", "b.csv"});
+    REQUIRE(args.get_all("-j") == std::vector<std::string>{"2"});
+    REQUIRE(args.get_all("-r").empty());
+}
+
+TEST_CASE("Test tokenizer", "[io]") {
+    using namespace seqmaker;
+    auto join = [](std::string_view a, std::string_view b, std::string_view c) {
+        return std::string{a} + '|' + std::string{b} + '|' + std::string{c};
+    };
+    auto rows = [&join](std::string_view delimiter, std::string_view block) {
+        std::vector<std::string> v;
+        io::Tokenizer{delimiter}.for_each_row<3>(
+            block, [&v, &join](auto... columns) { v.emplace_back(join(columns...)); });
+        return v;
+    };
+
+    REQUIRE(rows(",", "a,b,c\nd,e,f,g") == std::vector<std::string>{"a|b|c", "d|e|f"});
+    REQUIRE(rows(", ", "a, b,,c\r\n d ,e, f\r") == std::vector<std::string>{"a|b|c", "d|e|f"});
+    REQUIRE(rows(",", "a,b,c,\r\n") == std::vector<std::string>{"a|b|c"});
+    REQUIRE(rows(",", "").empty());
+    REQUIRE_THROWS_AS(rows(",", "a,b,c\na,b\n"), std::invalid_argument);
+    REQUIRE_THROWS_AS(rows(",", "a,b,\r\n"), std::invalid_argument);
+    REQUIRE_THROWS_AS(rows(",", "a,b,c\n\na,b,c"), std::invalid_argument);
+
+    // random lines across chunk boundaries compared to split_map
+    std::mt19937 g(0);   // NOLINT
+    const std::string alphabet{"aaaabbbb, ;\r"};
+    std::uniform_int_distribution<std::size_t> letter(0, alphabet.size() - 1);
+    std::uniform_int_distribution<std::size_t> line_length(5, 80);   // NOLINT
+    std::uniform_int_distribution<std::size_t> n_lines(0, 5);        // NOLINT
+    std::size_t n_valid = 0;
+    for (std::string_view delimiter : {",", ", ", ";, "}) {
+        for (auto i = 0; i < 200; i++) {   // NOLINT
+            std::string block;
+            for (auto n = n_lines(g); n > 0; n--) {
+                for (auto m = line_length(g); m > 0; m--) {
+                    block += alphabet[letter(g)];
+                }
+                block += '\n';
+            }
+            block.resize(block.size() - (i % 2 == 0 and not block.empty() ? 1 : 0));
+
+            std::vector<std::string> expected;
+            try {
+                auto f = [&expected, &join, delimiter](std::string_view line) {
+                    expected.emplace_back(utility::split_map(line, delimiter, join));
+                };
+                io::detail::for_each_line(block, f);
+            } catch (const std::invalid_argument&) {
+                REQUIRE_THROWS_AS(rows(delimiter, block), std::invalid_argument);
+                continue;
+            }
+            REQUIRE(rows(delimiter, block) == expected);
+            n_valid++;
+        }
+    }
+    REQUIRE(n_valid > 100);
+}
+
+TEST_CASE("Test MMSI counter", "[io]") {
+    using namespace seqmaker;
+
+    // counts of the second columns of the tokenizer in the order of count_mmsi
+    auto expected_counts = [](std::string_view delimiter, std::string_view block) {
+        std::map<ais::mmsi_t, std::size_t> hist;
+        io::Tokenizer{delimiter}.for_each_row<2>(
+            block, [&hist](std::string_view /* t */, std::string_view mmsi) {
+                constexpr ais::mmsi_t fallback = 0;
+                if (const auto x = utility::to_integer<ais::mmsi_t>(mmsi, fallback); x > 0) {
+                    hist[x]++;
+                }
+            });
+
+        std::vector<std::pair<ais::mmsi_t, std::size_t>> counts(hist.begin(), hist.end());
+        std::stable_sort(counts.begin(), counts.end(), [](auto a, auto b) {
+            return a.second > b.second;
+        });
+        return counts;
+    };
+
+    const std::string_view block{"1, 200000001, x\r\n"
+                                 "2,,  ,200000002\n"
+                                 ", 1, 200000001\r\n"
+                                 "3, 0, x\n"
+                                 "4, abc\n"
+                                 "5, 200000002"};
+    const auto counts = count_mmsi_block(block, ", ");
+    REQUIRE(counts == expected_counts(", ", block));
+    REQUIRE(counts.size() == 2);
+    REQUIRE(counts[0] == std::make_pair(ais::mmsi_t{200000001}, std::size_t{2}));
+    REQUIRE(counts[1] == std::make_pair(ais::mmsi_t{200000002}, std::size_t{2}));
+
+    REQUIRE_THROWS_AS(count_mmsi_block("1, 2\n3\n", ", "), std::invalid_argument);
+    REQUIRE_THROWS_AS(count_mmsi_block("1, \r\n", ", "), std::invalid_argument);
+    REQUIRE_THROWS_AS(count_mmsi_block("1, 2\n\n3, 4", ", "), std::invalid_argument);
+
+    // random lines, which are cut at random positions, compared to the tokenizer
+    std::mt19937 g(0);   // NOLINT
+    std::uniform_int_distribution<int> piece(0, 9);                           // NOLINT
+    std::uniform_int_distribution<ais::mmsi_t> mmsi(199999995, 200000005);   // NOLINT
+    std::uniform_int_distribution<std::size_t> n_lines(1, 50);               // NOLINT
+    std::size_t n_valid = 0;
+    for (std::string_view delimiter : {",", ", ", ";, "}) {
+        for (auto i = 0; i < 200; i++) {   // NOLINT
+            std::string block;
+            for (auto n = n_lines(g); n > 0; n--) {
+                for (auto k = piece(g) % 4; k > 0; k--) {
+                    block += delimiter[static_cast<std::size_t>(piece(g)) % delimiter.size()];
+                }
+                block += std::to_string(piece(g));
+                if (piece(g) > 0) {
+                    block += delimiter;
+                    block += piece(g) > 0 ? std::to_string(mmsi(g)) : std::string{"x1"};
+                }
+                if (piece(g) > 4) {
+                    block += delimiter;
+                    block += "more columns";
+                }
+                block += piece(g) > 6 ? "\r\n" : "\n";
+            }
+            block.resize(std::uniform_int_distribution<std::size_t>(1, block.size())(g));
+
+            std::vector<std::pair<ais::mmsi_t, std::size_t>> expected;
+            try {
+                expected = expected_counts(delimiter, block);
+            } catch (const std::invalid_argument&) {
+                REQUIRE_THROWS_AS(count_mmsi_block(block, delimiter), std::invalid_argument);
+                continue;
+            }
+            for (auto n_threads = 1U; n_threads <= 4U; n_threads++) {
+                REQUIRE(count_mmsi_block(block, delimiter, n_threads) == expected);
+            }
+            n_valid++;
+        }
+    }
+    REQUIRE(n_valid > 100);
+
+    // files that are counted by one worker each agree with the split of their concatenation
+    const auto dir = temp_path("counter");
+    std::filesystem::create_directory(dir);
+    std::vector<std::string> files;
+    std::string all_lines;
+    for (auto k = 0; k < 5; k++) {   // NOLINT
+        std::string lines;
+        for (auto n = k == 0 ? 0 : 1000 * k; n > 0; n--) {   // NOLINT
+            lines += std::to_string(piece(g)) + ", " + std::to_string(mmsi(g)) + ", x\n";
+        }
+        if (k == 4) {
+            lines += "4, 200000000";   // no line break at the end of the file
+        }
+        files.emplace_back((dir / ("part" + std::to_string(k) + ".csv")).string());
+        std::ofstream{files.back()} << lines;
+        all_lines += lines;
+    }
+
+    const auto expected = count_mmsi_block(all_lines, ", ");
+    for (auto n_threads = 1U; n_threads <= 8U; n_threads++) {   // NOLINT
+        REQUIRE(count_mmsi(", ", n_threads, files) == expected);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test pack file", "[io]") {
+    using namespace seqmaker;
+    std::mt19937 g(0);                                                      // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 100);                 // NOLINT
+    std::uniform_int_distribution<ais::Point::value_type> x(-1000, 1000);   // NOLINT
+
+    PackFile::Sequences seqs;
+    for (auto i = 0; i < 50; i++) {   // NOLINT
+        auto& seq = seqs[799999999 - 11 * i];
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            seq.emplace_back(ais::Point{.latitude = x(g), .longitude = x(g)});
+        }
+    }
+
+    const auto path = temp_path("pack.pack");
+    PackFile::write(path, seqs);
+
+    {
+        const PackFile pack{path};
+        REQUIRE(pack.size() == seqs.size());
+
+        auto require_equal = [](std::span<const ais::Point> points,
+                                const std::vector<ais::Point>& expected) {
+            REQUIRE(points.size() == expected.size());
+            for (std::size_t i = 0; i < expected.size(); i++) {
+                REQUIRE(points[i].latitude == expected[i].latitude);
+                REQUIRE(points[i].longitude == expected[i].longitude);
+            }
+        };
+
+        std::vector<ais::mmsi_t> mmsis;
+        pack.for_each([&seqs, &mmsis, &require_equal](auto mmsi, auto points) {
+            REQUIRE(seqs.contains(mmsi));
+            require_equal(points, seqs.at(mmsi));
+            mmsis.emplace_back(mmsi);
+        });
+        REQUIRE(mmsis.size() == seqs.size());
+        REQUIRE(std::is_sorted(mmsis.begin(), mmsis.end()));
+
+        for (const auto& [mmsi, seq] : seqs) {
+            const auto points = pack.find(mmsi);
+            REQUIRE(points.has_value());
+            require_equal(*points, seq);
+        }
+        REQUIRE(not pack.find(200000000).has_value());
+    }
+
+    // files with unordered or overlapping entries of the index are rejected
+    const auto bytes = [&path] {
+        std::vector<char> bytes(std::filesystem::file_size(path));
+        std::ifstream f(path, std::ios::binary);
+        f.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return bytes;
+    }();
+    auto require_corrupted = [&path, &bytes](std::size_t offset, std::size_t n, std::size_t by) {
+        auto corrupted = bytes;
+        std::swap_ranges(&corrupted[offset], &corrupted[offset + n], &corrupted[offset + by]);
+        {
+            std::ofstream f(path, std::ios::binary | std::ios::trunc);
+            f.write(corrupted.data(), static_cast<std::streamsize>(corrupted.size()));
+        }
+        REQUIRE_THROWS_AS(PackFile{path}, std::invalid_argument);
+    };
+    constexpr std::size_t INDEX = 64;
+    require_corrupted(INDEX, sizeof(ais::mmsi_t), sizeof(PackFile::Entry));   // MMSIs
+    require_corrupted(INDEX + 8, 8, sizeof(PackFile::Entry));                 // offsets
+    require_corrupted(INDEX + 16, 8, sizeof(PackFile::Entry));                // numbers of points
+
+    // a truncated file is rejected
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    REQUIRE_THROWS_AS(PackFile{path}, std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Test asynchronous writer", "[io]") {
+    using namespace seqmaker;
+    const auto dir = temp_path("writer");
+    std::filesystem::create_directory(dir);
+
+    auto read = [](const std::filesystem::path& path) {
+        std::string str(std::filesystem::file_size(path), '\0');
+        std::ifstream f(path, std::ios::binary);
+        f.read(str.data(), static_cast<std::streamsize>(str.size()));
+        return str;
+    };
+
+    {
+        // a small capacity such that writes have to wait for the writers
+        io::AsyncWriter writer{3, 16};   // NOLINT
+        for (auto i = 0; i < 20; i++) {   // NOLINT
+            const auto str = std::to_string(i);
+            writer.write(dir / str, std::vector<char>(str.begin(), str.end()));
+            writer.write(dir / "all", std::vector<char>(str.begin(), str.end()), std::ios::app);
+        }
+        writer.finish();
+    }
+
+    std::string expected;
+    for (auto i = 0; i < 20; i++) {   // NOLINT
+        REQUIRE(read(dir / std::to_string(i)) == std::to_string(i));
+        expected += std::to_string(i);
+    }
+    REQUIRE(read(dir / "all") == expected);
+
+    io::AsyncWriter writer{2};
+    writer.write(dir / "missing" / "file", std::vector<char>(1, 'x'));
+    REQUIRE_THROWS_AS(writer.finish(), std::system_error);
+
+    // a short write fits into the buffer of the stream and only fails once it is flushed
+    if (std::filesystem::exists("/dev/full")) {
+        io::AsyncWriter full{1};
+        full.write("/dev/full", std::vector<char>(1, 'x'));
+        REQUIRE_THROWS_AS(full.finish(), std::system_error);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Test packed encoding", "[io]") {
+    using namespace seqmaker;
+    REQUIRE(codec::to_format("packed") == codec::Format::packed);
+    REQUIRE(not codec::to_format("zip").has_value());
+    for (auto x : {0U, 1U, 2U, 0x7FFFFFFFU, 0x80000000U, 0xFFFFFFFFU}) {
+        REQUIRE(codec::unzigzag(codec::zigzag(x)) == x);
+    }
+    REQUIRE(codec::zigzag(static_cast<std::uint32_t>(-1)) == 1U);
+
+    // smooth rows, rows with full-width values and sizes around the block size
+    std::mt19937 g(0);   // NOLINT
+    std::uniform_int_distribution<std::int32_t> step(-100, 100);   // NOLINT
+    std::uniform_int_distribution<std::uint32_t> any;
+    std::vector<char> stream;
+    std::vector<std::uint32_t> expected;
+    for (auto n : {1U, 2U, 127U, 128U, 129U, 1000U}) {
+        for (auto delta : {false, true}) {
+            std::vector<std::uint32_t> rows(2 * n);
+            std::int32_t x = 52 * 600000;   // NOLINT
+            for (std::size_t i = 0; i < n; i++) {
+                x += step(g);
+                rows[2 * i] = static_cast<std::uint32_t>(x);
+                rows[2 * i + 1] = i % 100 == 99 ? any(g) : static_cast<std::uint32_t>(step(g));
+            }
+
+            std::vector<char> bytes;
+            codec::encode(rows, 2, delta, bytes);
+            REQUIRE(codec::decode(bytes) == rows);
+
+            // frames are appended to a common stream
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+            expected.insert(expected.end(), rows.begin(), rows.end());
+        }
+    }
+    REQUIRE(codec::decode(stream) == expected);
+    REQUIRE(codec::decode(std::span<const char>{}).empty());
+
+    // smooth rows are packed tightly
+    std::vector<std::uint32_t> smooth(2000, 1U << 30U);   // NOLINT
+    std::vector<char> bytes;
+    codec::encode(smooth, 2, true, bytes);
+    REQUIRE(bytes.size() < 100);
+
+    auto truncated = stream;
+    truncated.pop_back();
+    REQUIRE_THROWS_AS(codec::decode(truncated), std::invalid_argument);
+    auto corrupted = stream;
+    corrupted[0] = 'X';
+    REQUIRE_THROWS_AS(codec::decode(corrupted), std::invalid_argument);
+    REQUIRE_THROWS_AS(codec::encode(smooth, 3, true, bytes), std::invalid_argument);
+
+    // values are packed back to back, and the SIMD unpacking agrees with the scalar one
+    for (unsigned width = 0; width <= 32; width++) {
+        for (std::size_t n : {1U, 7U, 8U, 9U, 127U, 128U}) {
+            const auto mask = (std::uint64_t{1} << width) - 1;
+            std::vector<std::uint32_t> values(n);
+            std::vector<char> packed((n * width + 7) / 8 + 8);
+            for (std::size_t i = 0; i < n; i++) {
+                values[i] = static_cast<std::uint32_t>(any(g) & mask);
+                for (std::size_t b = 0; b < width; b++) {
+                    if ((values[i] >> b) & 1U) {
+                        const auto bit = i * width + b;
+                        packed[bit / 8] = static_cast<char>(packed[bit / 8] | (1 << (bit % 8)));
+                    }
+                }
+            }
+
+            std::vector<std::uint32_t> simd(n);
+            std::vector<std::uint32_t> scalar(n);
+            codec::detail::unpack(packed.data(), width, simd);
+            codec::detail::unpack_scalar(packed.data(), width, scalar);
+            REQUIRE(simd == values);
+            REQUIRE(scalar == values);
+        }
+    }
+
+    const auto path = temp_path("codec.pbin");
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f.write(stream.data(), static_cast<std::streamsize>(stream.size()));
+    }
+    REQUIRE(codec::decode_file(path) == expected);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Test histogram", "[utility]") {
+    using namespace seqmaker;
+    REQUIRE(not to_axis("1,2").has_value());
+    REQUIRE(not to_axis("2,1,10").has_value());
+    REQUIRE(not to_axis("0,1,10,log").has_value());
+    REQUIRE(not to_axis("0,1,0").has_value());
+    REQUIRE(not to_axis("0,1,10,lin").has_value());
+
+    const auto lin = to_axis("0,10,5");
+    REQUIRE(lin.has_value());
+    REQUIRE(not lin->is_log());
+    REQUIRE(lin->bin(-1.) == 0);
+    REQUIRE(lin->bin(std::numeric_limits<double>::quiet_NaN()) == 0);
+    REQUIRE(lin->bin(0.) == 1);
+    REQUIRE(lin->bin(1.9) == 1);
+    REQUIRE(lin->bin(2.) == 2);
+    REQUIRE(lin->bin(9.99) == 5);
+    REQUIRE(lin->bin(10.) == 6);
+    REQUIRE(lin->edge(0) == -std::numeric_limits<double>::infinity());
+    REQUIRE(lin->edge(3) == Approx{4.});
+    REQUIRE(lin->edge(6) == 10.);
+    REQUIRE(lin->edge(7) == std::numeric_limits<double>::infinity());
+
+    const auto log = to_axis("1,1000,3,log");
+    REQUIRE(log.has_value());
+    REQUIRE(log->is_log());
+    REQUIRE(log->bin(0.) == 0);
+    REQUIRE(log->bin(5.) == 1);
+    REQUIRE(log->bin(50.) == 2);
+    REQUIRE(log->bin(500.) == 3);
+    REQUIRE(log->bin(1000.) == 4);
+    REQUIRE(log->edge(2) == Approx{10.});
+    REQUIRE(log->edge(3) == Approx{100.});
+
+    // workers fill separate histograms that are merged
+    Histogram2D a{*lin, *log};
+    auto b = a;
+    a.fill(1., 5.);
+    a.fill(1., 5.);
+    b.fill(1., 5.);
+    b.fill(20., 0.);
+    a.merge(b);
+    REQUIRE(a.count(1, 1) == 3);
+    REQUIRE(a.count(6, 0) == 1);
+    REQUIRE(a.count(0, 0) == 0);
+}
+
 TEST_CASE("Test low pass filter", "[utility]") {
     using namespace seqmaker;
     auto filter = [](auto v) {
@@ -114,6 +974,23 @@ TEST_CASE("Test low pass filter", "[utility]") {
     REQUIRE(filter(std::vector{1, 2, 99, 99, 5, 6, 7}) == std::vector{1, 2, 99, 99, 5, 6, 7});
     REQUIRE(filter(std::vector{1, 2, 99, 4, 99, 6, 7}) == std::vector{1, 2, 6, 7});
     REQUIRE(filter(std::vector{1, 2, 99, 55, 5, 6, 7}) == std::vector{1, 2, 5, 6, 7});
+
+    // the filter by index agrees with the one by elements
+    std::mt19937 g(0);                                     // NOLINT
+    std::uniform_int_distribution<int> x(0, 4);            // NOLINT
+    std::uniform_int_distribution<std::size_t> n(0, 20);   // NOLINT
+    for (auto i = 0; i < 1000; i++) {                      // NOLINT
+        std::vector<int> v(n(g));
+        std::generate(v.begin(), v.end(), [&] { return x(g); });
+
+        auto w = v;
+        const auto last = utility::low_pass_filter_by_index(
+            w.begin(), w.end(), w.begin(), [&v](std::size_t j) {
+                return std::abs(v[j] - v[j + 1]) < 2;
+            });
+        w.erase(last, w.end());
+        REQUIRE(w == filter(v));
+    }
 }
 
 TEST_CASE("Test interpolation", "[seq]") {
@@ -198,10 +1075,16 @@ TEST_CASE("Test split", "[seq]") {
                                     .dt_max = dt_max,
                                     .dti = dti,
                                     .ds_max = ds_max,
-                                    .v_min = 0.};
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
     const auto rate = drop_rate(trajectory, split_args);
     REQUIRE(rate == Approx(4. / static_cast<double>(trajectory.size())));   // NOLINT
 
+    // buffers of a longer trajectory are reused
+    SplitBuffers buffers;
+    buffers.ds.assign(2 * trajectory.size(), -1.);
+    REQUIRE(drop_rate(trajectory, split_args, buffers) == rate);
+
     const auto seq = split(trajectory, split_args);
     REQUIRE(seq.size() == seq_expected.size());
 
@@ -211,6 +1094,88 @@ TEST_CASE("Test split", "[seq]") {
     }
 }
 
+TEST_CASE("Test split with reused buffers", "[seq]") {
+    using namespace seqmaker;
+    auto make_pos = [](ais::time_t t, ais::Point::value_type lat) {
+        return ais::Position{.t = t, .x = ais::Point{.latitude = lat, .longitude = 0}};
+    };
+
+    // a slow piece followed by two fast pieces of 5 s each, 10000 units are 1 NM
+    const ais::Trajectory trajectory{make_pos(0, 0),
+                                     make_pos(5, 100),
+                                     make_pos(10, 200),
+                                     make_pos(15, 9000),
+                                     make_pos(20, 18000),
+                                     make_pos(25, 27000)};
+    auto args = split_args{.seq_length = 5,
+                           .dt_max = 10,
+                           .dti = 1,
+                           .ds_max = 1.,
+                           .v_min = 0.,
+                           .metric = ais::Metric::equirectangular};
+
+    SplitBuffers buffers;
+    std::vector<ais::Point> seqs(3 * (args.seq_length + 1));
+    auto last = split(trajectory, args, buffers, seqs.begin());
+    REQUIRE(last == seqs.end());
+    const auto expected = split(trajectory, args);
+    REQUIRE(seqs.size() == expected.size());
+    for (auto i = 0U; i < seqs.size(); i++) {
+        REQUIRE(seqs[i].latitude == expected[i].latitude);
+        REQUIRE(seqs[i].longitude == expected[i].longitude);
+    }
+
+    // 100 units in 5 s are 7.2 kt, 8800 units in 5 s are about 630 kt
+    args.v_min = 100.;   // NOLINT
+    seqs.clear();
+    split(trajectory, args, buffers, std::back_inserter(seqs));
+    REQUIRE(seqs.size() == 2 * (args.seq_length + 1));
+    REQUIRE(seqs.front().latitude == 200);
+    REQUIRE(seqs.back().latitude == 27000);
+
+    const std::vector<ais::Point> points(1000, ais::Point{.latitude = 0, .longitude = 0});
+    auto zigzag = points;
+    for (std::size_t i = 0; i < zigzag.size(); i += 2) {
+        zigzag[i].latitude = 600;   // 1/1000 degree or 0.06 NM
+    }
+    REQUIRE(ais::acc_dist_nm(points) == 0.);
+    REQUIRE(ais::acc_dist_nm(zigzag) == Approx{999. * .06});
+    REQUIRE(ais::acc_dist_nm(zigzag, 1.) >= 1.);
+    REQUIRE(ais::acc_dist_nm(zigzag, 1.) < 10.);
+}
+
+TEST_CASE("Test grouping of trajectories", "[seqmaker]") {
+    using namespace seqmaker;
+    auto make_pos = [](ais::time_t t) {
+        return ais::Position{.t = t, .x = ais::Point{.latitude = 0, .longitude = 0}};
+    };
+
+    TrajectoryStore store;
+    store.append({{1, make_pos(10)}, {2, make_pos(20)}, {1, make_pos(11)}});
+    store.append({{3, make_pos(30)}, {1, make_pos(12)}});
+    store.group();
+    store.append({{2, make_pos(21)}, {4, make_pos(40)}});
+    store.group();
+
+    auto times = [&store](std::size_t i) {
+        std::vector<ais::time_t> t;
+        for (auto pos : std::as_const(store).trajectory(i)) {
+            t.emplace_back(pos.t);
+        }
+        return t;
+    };
+
+    REQUIRE(store.size() == 4);
+    REQUIRE(store.mmsi(0) == 1);
+    REQUIRE(times(0) == std::vector<ais::time_t>{10, 11, 12});
+    REQUIRE(store.mmsi(1) == 2);
+    REQUIRE(times(1) == std::vector<ais::time_t>{20, 21});
+    REQUIRE(store.mmsi(2) == 3);
+    REQUIRE(times(2) == std::vector<ais::time_t>{30});
+    REQUIRE(store.mmsi(3) == 4);
+    REQUIRE(times(3) == std::vector<ais::time_t>{40});
+}
+
 TEST_CASE("Test seqmaker with LPF", "[seqmaker]") {
     using namespace seqmaker;
     auto make_pos = [](ais::time_t t, ais::Point::value_type lat, ais::Point::value_type lon) {
@@ -293,7 +1258,8 @@ TEST_CASE("Test seqmaker with LPF", "[seqmaker]") {
                                               .dt_max = dt_max,
                                               .dti = dti,
                                               .ds_max = ds_max,
-                                              .v_min = 0.},
+                                              .v_min = 0.,
+                                              .metric = ais::Metric::equirectangular},
                                    ""};
     seq_maker.add_trajectory(MMSI, trajectory);
     for (auto [mmsi, seq] : seq_maker.run(true)) {
@@ -307,3 +1273,720 @@ TEST_CASE("Test seqmaker with LPF", "[seqmaker]") {
         }
     }
 }
+
+TEST_CASE("Test parallel seqmaker", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = 5. / (600000. / 60.),
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
+
+    std::mt19937 g(0);                                        // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 500);   // NOLINT
+    std::uniform_int_distribution<unsigned> jitter(0, 2);     // NOLINT
+
+    std::vector<std::pair<ais::mmsi_t, ais::Trajectory>> trajectories;
+    for (auto i = 0; i < 32; i++) {   // NOLINT
+        ais::Trajectory trajectory;
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            const auto x = static_cast<ais::Point::value_type>(j);
+            trajectory.emplace_back(ais::Position{
+                .t = 10 * j + jitter(g), .x = ais::Point{.latitude = x, .longitude = x}});
+        }
+        std::shuffle(trajectory.begin(), trajectory.end(), g);
+        trajectories.emplace_back(200000000 + i, trajectory);
+    }
+
+    auto run = [&trajectories, split_args](unsigned n_threads, bool use_sink) {
+        auto seq_maker = SequenceMaker{split_args, "", n_threads};
+        for (const auto& [mmsi, trajectory] : trajectories) {
+            seq_maker.add_trajectory(mmsi, trajectory);
+        }
+        if (not use_sink) {
+            return seq_maker.run(true);
+        }
+
+        std::mutex mutex;
+        std::unordered_map<ais::mmsi_t, std::vector<ais::Point>> seqs;
+        seq_maker.run(true, [&mutex, &seqs](ais::mmsi_t mmsi, std::span<const ais::Point> seq) {
+            const std::lock_guard lock{mutex};
+            REQUIRE(seqs.emplace(mmsi, std::vector<ais::Point>(seq.begin(), seq.end())).second);
+        });
+        return seqs;
+    };
+
+    const auto expected = run(1, false);
+    REQUIRE(not expected.empty());
+
+    for (auto use_sink : {false, true}) {
+        const auto seqs = run(4, use_sink);
+        REQUIRE(seqs.size() == expected.size());
+        for (const auto& [mmsi, seq] : expected) {
+            REQUIRE(seqs.contains(mmsi));
+            REQUIRE(seqs.at(mmsi).size() == seq.size());
+            for (auto i = 0U; i < seq.size(); i++) {
+                REQUIRE(seqs.at(mmsi)[i].latitude == seq[i].latitude);
+                REQUIRE(seqs.at(mmsi)[i].longitude == seq[i].longitude);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test seqmaker with spilled input", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = 5. / (600000. / 60.),
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
+
+    std::mt19937 g(0);                                        // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 500);   // NOLINT
+
+    std::vector<std::pair<ais::mmsi_t, ais::Trajectory>> trajectories;
+    for (auto i = 0; i < 32; i++) {   // NOLINT
+        ais::Trajectory trajectory;
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            const auto x = static_cast<ais::Point::value_type>(j);
+            trajectory.emplace_back(
+                ais::Position{.t = 10 * j, .x = ais::Point{.latitude = x, .longitude = x}});
+        }
+        trajectories.emplace_back(200000000 + i, trajectory);
+    }
+
+    auto run = [&trajectories, split_args](std::size_t mem_limit, unsigned n_threads) {
+        auto seq_maker = SequenceMaker{split_args,
+                                       input_args{.delimiter = "",
+                                                  .n_threads = n_threads,
+                                                  .radix_sort = false,
+                                                  .mem_limit = mem_limit}};
+
+        // the positions of each trajectory are added in two parts, interleaved with the others
+        for (auto second_half : {false, true}) {
+            for (const auto& [mmsi, trajectory] : trajectories) {
+                const auto n = trajectory.size() / 2;
+                seq_maker.add_trajectory(mmsi,
+                                         second_half ? ais::TrajectoryView{trajectory}.subspan(n)
+                                                     : ais::TrajectoryView{trajectory}.first(n));
+            }
+        }
+        return seq_maker.run(false);
+    };
+
+    const auto expected = run(0, 1);
+    REQUIRE(not expected.empty());
+
+    for (auto n_threads : {1U, 3U}) {
+        const auto seqs = run(4096, n_threads);   // NOLINT
+        REQUIRE(seqs.size() == expected.size());
+        for (const auto& [mmsi, seq] : expected) {
+            REQUIRE(seqs.contains(mmsi));
+            REQUIRE(seqs.at(mmsi).size() == seq.size());
+            for (auto i = 0U; i < seq.size(); i++) {
+                REQUIRE(seqs.at(mmsi)[i].latitude == seq[i].latitude);
+                REQUIRE(seqs.at(mmsi)[i].longitude == seq[i].longitude);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test seqmaker with cached input", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = 5. / (600000. / 60.),
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
+
+    std::mt19937 g(0);                                        // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 500);   // NOLINT
+    std::uniform_int_distribution<int> jitter(-20, 20);       // NOLINT
+
+    // positions in arbitrary order of MMSIs and times, including duplicate times and outliers
+    TrajectoryStore::Batch batch;
+    for (auto i = 0; i < 32; i++) {   // NOLINT
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            const auto x = static_cast<ais::Point::value_type>(j % 50 == 0 ? 100000 : j);
+            batch.emplace_back(
+                799999999 - 7 * i,
+                ais::Position{.t = 10 * j + 5 * static_cast<unsigned>(jitter(g) > 15),
+                              .x = ais::Point{.latitude = x, .longitude = x}});
+        }
+    }
+    std::shuffle(batch.begin(), batch.end(), g);
+
+    TrajectoryStore store;
+    store.append(batch);
+    store.sort(1);
+
+    const auto path = temp_path("cache.aiscache");
+    TrajectoryCache::write(path, store);
+
+    auto require_cached = [&store, &path]() {
+        const TrajectoryCache cache{path};
+        REQUIRE(cache.size() == store.size());
+        for (std::size_t i = 0; i < store.size(); i++) {
+            REQUIRE(cache.mmsi(i) == store.mmsi(i));
+            REQUIRE(cache.find(store.mmsi(i)) == i);
+
+            const auto expected = std::as_const(store).trajectory(i);
+            const auto trajectory = cache.trajectory(i);
+            REQUIRE(trajectory.size() == expected.size());
+            for (std::size_t j = 0; j < expected.size(); j++) {
+                REQUIRE(trajectory[j].t == expected[j].t);
+                REQUIRE(trajectory[j].x.latitude == expected[j].x.latitude);
+                REQUIRE(trajectory[j].x.longitude == expected[j].x.longitude);
+            }
+        }
+        REQUIRE(not cache.find(200000000).has_value());
+    };
+    require_cached();
+
+    for (auto apply_low_pass_filter : {false, true}) {
+        auto seq_maker = SequenceMaker{split_args,
+                                       input_args{.delimiter = "",
+                                                  .n_threads = 1,
+                                                  .radix_sort = true,
+                                                  .mem_limit = 0}};
+        for (auto [mmsi, position] : batch) {
+            seq_maker.add_trajectory(mmsi, ais::TrajectoryView{&position, 1});
+        }
+        const auto expected = seq_maker.run(apply_low_pass_filter);
+        REQUIRE(not expected.empty());
+
+        for (auto n_threads : {1U, 3U}) {
+            const auto seqs = SequenceMaker{split_args,
+                                            input_args{.delimiter = "",
+                                                       .n_threads = n_threads,
+                                                       .radix_sort = false,
+                                                       .mem_limit = 0,
+                                                       .cache = path.native()}}
+                                  .run(apply_low_pass_filter);
+            REQUIRE(seqs.size() == expected.size());
+            for (const auto& [mmsi, seq] : expected) {
+                REQUIRE(seqs.contains(mmsi));
+                REQUIRE(seqs.at(mmsi).size() == seq.size());
+                for (auto i = 0U; i < seq.size(); i++) {
+                    REQUIRE(seqs.at(mmsi)[i].latitude == seq[i].latitude);
+                    REQUIRE(seqs.at(mmsi)[i].longitude == seq[i].longitude);
+                }
+            }
+        }
+    }
+
+    // filtering trajectories in place does not modify the file
+    require_cached();
+
+    // a file with unordered MMSIs is rejected
+    {
+        constexpr std::size_t MMSIS = 64;
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        const auto mmsi = store.mmsi(1);
+        f.seekp(MMSIS);
+        f.write(reinterpret_cast<const char*>(&mmsi), sizeof(mmsi));   // NOLINT
+    }
+    REQUIRE_THROWS_AS(TrajectoryCache{path}, std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Test seqmaker sweep", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr split_args defaults{.seq_length = 5U,
+                                  .dt_max = 15U,
+                                  .dti = 5U,
+                                  .ds_max = 5. / (600000. / 60.),
+                                  .v_min = 0.,
+                                  .metric = ais::Metric::equirectangular};
+
+    const auto configs = expand_grid("-N 5,8 \t-s 0.0005,.001,1 -v 0", defaults);
+    REQUIRE(configs.size() == 6);
+    REQUIRE(configs[1].seq_length == 5U);
+    REQUIRE(configs[1].ds_max == 0.001);
+    REQUIRE(configs[5].seq_length == 8U);
+    REQUIRE(configs[5].ds_max == 1.);
+    for (const auto& config : configs) {
+        REQUIRE(config.dt_max == defaults.dt_max);
+        REQUIRE(config.dti == defaults.dti);
+    }
+    REQUIRE(expand_grid("", defaults).size() == 1);
+    REQUIRE_THROWS_AS(expand_grid("-N", defaults), std::invalid_argument);
+    REQUIRE_THROWS_AS(expand_grid("-N 0", defaults), std::invalid_argument);
+    REQUIRE_THROWS_AS(expand_grid("-s 1,x", defaults), std::invalid_argument);
+    REQUIRE_THROWS_AS(expand_grid("-v -1", defaults), std::invalid_argument);
+    REQUIRE_THROWS_AS(expand_grid("-l 1", defaults), std::invalid_argument);
+    REQUIRE_THROWS_AS(expand_grid("-t 1 -t 2", defaults), std::invalid_argument);
+
+    std::mt19937 g(0);                                        // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 300);   // NOLINT
+    std::uniform_int_distribution<int> step(-3, 8);           // NOLINT
+
+    // random walks with gaps in time and outliers
+    std::vector<std::pair<ais::mmsi_t, ais::Trajectory>> trajectories;
+    for (auto i = 0; i < 32; i++) {   // NOLINT
+        ais::Trajectory trajectory;
+        ais::Point::value_type x = 0;
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            x += step(g);
+            const auto y = j % 40 == 7 ? x + 10000 : x;
+            trajectory.emplace_back(ais::Position{
+                .t = 5 * j + (j / 100) * 20, .x = ais::Point{.latitude = y, .longitude = x}});
+        }
+        std::shuffle(trajectory.begin(), trajectory.end(), g);
+        trajectories.emplace_back(200000000 + i, trajectory);
+    }
+
+    auto add_trajectories = [&trajectories](Sequencer& sequencer) {
+        for (const auto& [mmsi, trajectory] : trajectories) {
+            sequencer.add_trajectory(mmsi, trajectory);
+        }
+    };
+
+    for (auto apply_low_pass_filter : {false, true}) {
+        for (auto n_threads : {1U, 3U}) {
+            auto sweep
+                = SequenceSweep{configs, input_args{.delimiter = "", .n_threads = n_threads}};
+            add_trajectories(sweep);
+            const auto results = sweep.run(apply_low_pass_filter, false);
+            REQUIRE(results.size() == configs.size());
+            REQUIRE(results.front().n_sequences > 0);
+            REQUIRE(results.front().n_sequences < results.back().n_sequences);
+
+            for (std::size_t k = 0; k < configs.size(); k++) {
+                auto seq_maker = SequenceMaker{configs[k]};
+                add_trajectories(seq_maker);
+                const auto expected = seq_maker.run(apply_low_pass_filter);
+
+                std::size_t n_sequences = 0;
+                const auto& seqs = results[k].seqs;
+                REQUIRE(seqs.size() == expected.size());
+                for (const auto& [mmsi, seq] : expected) {
+                    REQUIRE(seqs.contains(mmsi));
+                    REQUIRE(seqs.at(mmsi).size() == seq.size());
+                    for (auto i = 0U; i < seq.size(); i++) {
+                        REQUIRE(seqs.at(mmsi)[i].latitude == seq[i].latitude);
+                        REQUIRE(seqs.at(mmsi)[i].longitude == seq[i].longitude);
+                    }
+                    n_sequences += seq.size() / (configs[k].seq_length + 1);
+                }
+                REQUIRE(results[k].n_sequences == n_sequences);
+
+                auto seq_counter = SequenceCounter{configs[k]};
+                add_trajectories(seq_counter);
+                const auto drop_rates = seq_counter.run(apply_low_pass_filter);
+                REQUIRE(results[k].drop_rates == drop_rates);
+            }
+        }
+    }
+
+    // sequences passed to a sink are the ones that are otherwise kept
+    auto sweep = SequenceSweep{configs, input_args{.delimiter = "", .n_threads = 3}};
+    add_trajectories(sweep);
+    const auto expected = sweep.run(true, false);
+
+    std::mutex mutex;
+    std::vector<std::unordered_map<ais::mmsi_t, std::vector<ais::Point>>> seqs(configs.size());
+    std::size_t n_calls = 0;
+    auto sink_sweep = SequenceSweep{configs, input_args{.delimiter = "", .n_threads = 3}};
+    add_trajectories(sink_sweep);
+    auto sink = [&mutex, &seqs, &n_calls](
+                    std::size_t k, ais::mmsi_t mmsi, std::span<const ais::Point> seq) {
+        const std::lock_guard lock{mutex};
+        seqs[k].emplace(mmsi, std::vector(seq.begin(), seq.end()));
+        n_calls++;
+    };
+    const auto results = sink_sweep.run(true, sink);
+    std::size_t n_mmsis = 0;
+    for (const auto& result : expected) {
+        n_mmsis += result.seqs.size();
+    }
+    REQUIRE(n_calls == n_mmsis);
+    for (std::size_t k = 0; k < configs.size(); k++) {
+        REQUIRE(results[k].seqs.empty());
+        REQUIRE(results[k].n_sequences == expected[k].n_sequences);
+        REQUIRE(seqs[k].size() == expected[k].seqs.size());
+        for (const auto& [mmsi, seq] : expected[k].seqs) {
+            REQUIRE(seqs[k].contains(mmsi));
+            REQUIRE(seqs[k].at(mmsi).size() == seq.size());
+            for (auto i = 0U; i < seq.size(); i++) {
+                REQUIRE(seqs[k].at(mmsi)[i].latitude == seq[i].latitude);
+                REQUIRE(seqs[k].at(mmsi)[i].longitude == seq[i].longitude);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test streaming seqmaker", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = 5. / (600000. / 60.),
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
+    constexpr auto REORDER_WINDOW = 20U;
+
+    std::mt19937 g(0);                                        // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 200);   // NOLINT
+    std::uniform_int_distribution<unsigned> delay(0, REORDER_WINDOW);
+
+    // staggered trajectories with a gap of more than dt_max in the middle of each
+    std::vector<std::pair<ais::mmsi_t, ais::Position>> stream;
+    std::vector<std::pair<ais::mmsi_t, ais::Trajectory>> trajectories;
+    for (auto i = 0; i < 8; i++) {   // NOLINT
+        ais::Trajectory trajectory;
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            const auto t0 = 1000 * static_cast<ais::time_t>(i);   // NOLINT
+            const auto t = t0 + 10 * j + (j < n / 2 ? 0 : 100);   // NOLINT
+            const auto x = static_cast<ais::Point::value_type>(j);
+            trajectory.emplace_back(ais::Position{.t = t, .x = {.latitude = x, .longitude = x}});
+        }
+        trajectories.emplace_back(200000000 + i, trajectory);
+    }
+
+    // arrival in order of time plus a random delay within the reorder window
+    std::vector<std::pair<unsigned, std::size_t>> arrivals;
+    for (const auto& [mmsi, trajectory] : trajectories) {
+        for (auto pos : trajectory) {
+            arrivals.emplace_back(pos.t + delay(g), stream.size());
+            stream.emplace_back(mmsi, pos);
+        }
+    }
+    std::sort(arrivals.begin(), arrivals.end());
+
+    std::unordered_map<ais::mmsi_t, std::vector<ais::Point>> seqs;
+    auto sink = [&seqs, split_args](ais::mmsi_t mmsi, std::span<const ais::Point> seq) {
+        REQUIRE(seq.size() == split_args.seq_length + 1);
+        auto& s = seqs[mmsi];
+        s.insert(s.end(), seq.begin(), seq.end());
+    };
+
+    SequenceStreamer streamer{split_args, stream_args{.reorder_window = REORDER_WINDOW}, sink};
+    std::size_t max_active = 0;
+    ais::time_t t_max = 0;
+    for (auto [t, i] : arrivals) {
+        streamer.push(stream[i].first, stream[i].second);
+        t_max = std::max(t_max, stream[i].second.t);
+
+        // a vessel is evicted at the latest dt_max seconds after the stream has advanced by more
+        // than the reorder window plus dt_max beyond its last position
+        const auto is_active = [t_max, split_args](const auto& trajectory) {
+            const auto& positions = trajectory.second;
+            return positions.front().t <= t_max
+                   and positions.back().t + REORDER_WINDOW + 2 * split_args.dt_max >= t_max;
+        };
+        const auto n_active = static_cast<std::size_t>(
+            std::count_if(trajectories.begin(), trajectories.end(), is_active));
+        REQUIRE(streamer.n_active() <= n_active);
+        max_active = std::max(max_active, streamer.n_active());
+    }
+    streamer.finish();
+
+    REQUIRE(streamer.n_dropped() == 0);
+    REQUIRE(streamer.n_active() == 0);
+    REQUIRE(max_active < trajectories.size());
+
+    for (const auto& [mmsi, trajectory] : trajectories) {
+        const auto expected = split(trajectory, split_args);
+        REQUIRE(seqs[mmsi].size() == expected.size());
+        for (auto i = 0U; i < expected.size(); i++) {
+            REQUIRE(seqs[mmsi][i].latitude == expected[i].latitude);
+            REQUIRE(seqs[mmsi][i].longitude == expected[i].longitude);
+        }
+    }
+
+    // a position older than the last one passed on is dropped
+    streamer.push(200000000, ais::Position{.t = 1000, .x = {.latitude = 0, .longitude = 0}});
+    streamer.push(200000000, ais::Position{.t = 900, .x = {.latitude = 0, .longitude = 0}});
+    REQUIRE(streamer.n_dropped() == 1);
+}
+
+TEST_CASE("Test streaming seqmaker at the distance threshold", "[seqmaker]") {
+    using namespace seqmaker;
+    constexpr ais::mmsi_t mmsi = 200000000;
+    constexpr ais::Point::value_type one_deg = 600000;
+    constexpr ais::Point::value_type step = 1000;
+
+    // steps of about the threshold, where the distance of a step varies with the latitude
+    std::mt19937 g(0);                                                 // NOLINT
+    std::uniform_int_distribution<ais::Point::value_type> d(-1, 1);   // NOLINT
+    ais::Trajectory trajectory;
+    ais::Point x{.latitude = 52 * one_deg, .longitude = 13 * one_deg};
+    for (auto j = 0U; j < 2000; j++) {   // NOLINT
+        trajectory.emplace_back(ais::Position{.t = 10 * j, .x = x});
+        x.latitude += step + d(g);
+        x.longitude += step + (j % 50 == 0 ? 3 * step : d(g));   // NOLINT
+    }
+
+    for (auto metric : {ais::Metric::equirectangular, ais::Metric::flat}) {
+        // the threshold is the distance of the first step
+        const auto ds_max = ais::with_metric(metric, [&trajectory](auto m) {
+            using M = decltype(m);
+            return M::to_nm(M::dist(trajectory[0].x, trajectory[1].x));
+        });
+        const split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = ds_max,
+                                    .v_min = 0.,
+                                    .metric = metric};
+
+        for (auto lpf : {false, true}) {
+            std::vector<ais::Point> streamed;
+            SequenceStreamer streamer{
+                split_args,
+                stream_args{.reorder_window = 0, .apply_low_pass_filter = lpf},
+                [&streamed](ais::mmsi_t /* mmsi */, std::span<const ais::Point> seq) {
+                    streamed.insert(streamed.end(), seq.begin(), seq.end());
+                }};
+            for (auto pos : trajectory) {
+                streamer.push(mmsi, pos);
+            }
+            streamer.finish();
+
+            SequenceMaker seq_maker{split_args};
+            seq_maker.add_trajectory(mmsi, trajectory);
+            const auto seqs = seq_maker.run(lpf);
+
+            REQUIRE(not streamed.empty());
+            REQUIRE(seqs.at(mmsi).size() == streamed.size());
+            for (std::size_t i = 0; i < streamed.size(); i++) {
+                REQUIRE(seqs.at(mmsi)[i].latitude == streamed[i].latitude);
+                REQUIRE(seqs.at(mmsi)[i].longitude == streamed[i].longitude);
+            }
+        }
+    }
+}
+
+TEST_CASE("Test seqdiff with several strides", "[seqdiff]") {
+    using namespace seqmaker;
+    std::mt19937 g(0);                                                     // NOLINT
+    std::uniform_int_distribution<unsigned> length(1, 100);                // NOLINT
+    std::uniform_int_distribution<ais::Point::value_type> step(-50, 50);   // NOLINT
+
+    std::vector<std::pair<ais::mmsi_t, ais::Trajectory>> trajectories;
+    for (auto i = 0; i < 16; i++) {   // NOLINT
+        ais::Trajectory trajectory;
+        ais::Point x{.latitude = 0, .longitude = 0};
+        for (auto j = 0U, n = length(g); j < n; j++) {
+            x.latitude += step(g);
+            x.longitude += step(g);
+            trajectory.emplace_back(ais::Position{.t = 10 * j, .x = x});
+        }
+        trajectories.emplace_back(200000000 + i, trajectory);
+    }
+    // trajectories are added in another order than the one of their MMSIs
+    std::shuffle(trajectories.begin(), trajectories.end(), g);
+
+    auto make = [&trajectories](unsigned n_threads = 3) {
+        SequenceDiff seq_diff{input_args{.delimiter = "", .n_threads = n_threads}};
+        for (const auto& [mmsi, trajectory] : trajectories) {
+            seq_diff.add_trajectory(mmsi, trajectory);
+        }
+        return seq_diff;
+    };
+
+    const std::vector strides{1U, 2U, 7U, 64U};
+    std::vector<std::vector<SequenceDiff::Diff>> diffs(strides.size());
+    make().run(strides, [&diffs](std::size_t k, std::span<const SequenceDiff::Diff> d) {
+        diffs[k].insert(diffs[k].end(), d.begin(), d.end());
+    });
+
+    const auto axis = *to_axis("0,1000,10");
+    const auto hists = make().run(strides, Histogram2D{axis, axis});
+    REQUIRE(hists.size() == strides.size());
+
+    // each stride yields the same differences in the same order as a separate pass, independent
+    // of the number of threads
+    for (std::size_t k = 0; k < strides.size(); k++) {
+        const auto expected = make(1).run(strides[k]);
+        REQUIRE(diffs[k] == expected);
+        REQUIRE(make().run(strides[k]) == expected);
+
+        std::uint64_t n = 0;
+        for (std::size_t i = 0; i < axis.n_bins() + std::size_t{2}; i++) {
+            for (std::size_t j = 0; j < axis.n_bins() + std::size_t{2}; j++) {
+                n += hists[k].count(i, j);
+            }
+        }
+        REQUIRE(n == expected.size());
+    }
+    REQUIRE(not diffs[0].empty());
+
+    // the differences of the trajectories follow each other in ascending order of MMSIs
+    auto by_mmsi = trajectories;
+    std::sort(by_mmsi.begin(), by_mmsi.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    std::vector<SequenceDiff::Diff> expected;
+    for (const auto& [mmsi, trajectory] : by_mmsi) {
+        SequenceDiff seq_diff{input_args{.delimiter = "", .n_threads = 1}};
+        seq_diff.add_trajectory(mmsi, trajectory);
+        const auto diff = seq_diff.run(strides[0]);
+        expected.insert(expected.end(), diff.begin(), diff.end());
+    }
+    REQUIRE(diffs[0] == expected);
+}
+
+TEST_CASE("Test synthetic AIS data", "[aisgen]") {
+    using namespace seqmaker;
+    const gen::gen_args args{.n_positions = 20000,   // NOLINT
+                             .n_vessels = 50,        // NOLINT
+                             .seed = 7,              // NOLINT
+                             .days = 1,
+                             .p_duplicate = .05,     // NOLINT
+                             .p_gap = .01,           // NOLINT
+                             .p_jump = .01,          // NOLINT
+                             .p_invalid = .05};      // NOLINT
+
+    auto csv = [](const gen::Generator& generator) {
+        std::string lines;
+        generator.write_csv([&lines](std::string_view chunk) { lines += chunk; });
+        return lines;
+    };
+
+    const gen::Generator generator{args};
+    const auto lines = csv(generator);
+    REQUIRE(lines == csv(gen::Generator{args}));
+    REQUIRE(lines != csv(gen::Generator{gen::gen_args{.seed = 8}}));
+
+    std::uint64_t n_positions = 0;
+    for (const auto& vessel : generator.vessels()) {
+        REQUIRE(ais::is_valid_mmsi(vessel.mmsi));
+        REQUIRE(vessel.n > 0);
+        n_positions += vessel.n;
+    }
+    REQUIRE(n_positions == args.n_positions);
+
+    // the valid positions without duplicates are the ones of the generated cache
+    TrajectoryStore store;
+    store.append(parse_ais_lines(lines, args.delimiter));
+    REQUIRE(store.n_staged() > args.n_positions);
+    store.sort(1);
+
+    const auto path = temp_path("gen.aiscache");
+    generator.write_cache(path);
+    const TrajectoryCache cache{path};
+    REQUIRE(cache.n_positions() == args.n_positions);
+    REQUIRE(cache.size() == store.size());
+    for (std::size_t i = 0; i < store.size(); i++) {
+        REQUIRE(cache.mmsi(i) == store.mmsi(i));
+
+        const auto expected = std::as_const(store).trajectory(i);
+        const auto trajectory = cache.trajectory(i);
+        REQUIRE(trajectory.size() == expected.size());
+        for (std::size_t j = 0; j < expected.size(); j++) {
+            REQUIRE(trajectory[j].t == expected[j].t);
+            REQUIRE(trajectory[j].x.latitude == expected[j].x.latitude);
+            REQUIRE(trajectory[j].x.longitude == expected[j].x.longitude);
+        }
+    }
+    std::filesystem::remove(path);
+
+    gen::gen_args no_vessels{};
+    no_vessels.n_vessels = 0;
+    REQUIRE_THROWS_AS(gen::Generator{no_vessels}, std::invalid_argument);
+
+    // more than one position per second
+    gen::gen_args too_many{};
+    too_many.n_positions = 86401;   // NOLINT
+    too_many.n_vessels = 1;
+    too_many.days = 1;
+    REQUIRE_THROWS_AS(gen::Generator{too_many}, std::invalid_argument);
+}
+
+TEST_CASE("Test statistics", "[stats]") {
+    using namespace seqmaker;
+    stats::enable();
+    stats::reset();
+
+    // other tests run without recording, even if this one fails
+    struct Disable {
+        ~Disable() {
+            stats::disable();
+            stats::reset();
+        }
+    } disable;
+
+    const std::string lines{"1456804265.529, 468087407, 4, 22652851, -52369144\n"
+                            "1456831639.506, 148295021, 18, 15122070, 13705075\n"
+                            "1456831639.506, 248295021, 60, 15122070, 13705075\n"
+                            "1456831639.506, 248295021, 18, 150000000, 13705075\n"
+                            "0.5, 248295021, 18, 15122070, 13705075\n"
+                            "abc, 0, 60, 150000000, 13705075\n"};
+    REQUIRE(parse_ais_lines(lines, ", ").size() == 1);
+    REQUIRE(stats::get(stats::Counter::rows_parsed) == 6);
+    REQUIRE(stats::get(stats::Counter::rows_rejected_time) == 2);
+    REQUIRE(stats::get(stats::Counter::rows_rejected_mmsi) == 1);
+    REQUIRE(stats::get(stats::Counter::rows_rejected_slot) == 1);
+    REQUIRE(stats::get(stats::Counter::rows_rejected_position) == 1);
+
+    constexpr split_args split_args{.seq_length = 5U,
+                                    .dt_max = 15U,
+                                    .dti = 5U,
+                                    .ds_max = 5. / (600000. / 60.),
+                                    .v_min = 0.,
+                                    .metric = ais::Metric::equirectangular};
+
+    // two sequences and a duplicate time, and a trajectory that is too short
+    ais::Trajectory trajectory;
+    for (auto j = 0U; j < 12U; j++) {   // NOLINT
+        const auto x = static_cast<ais::Point::value_type>(j);
+        trajectory.emplace_back(
+            ais::Position{.t = 5 * j, .x = ais::Point{.latitude = x, .longitude = x}});
+    }
+    trajectory.emplace_back(trajectory[2]);
+
+    auto seq_maker = SequenceMaker{split_args, "", 1U};
+    seq_maker.add_trajectory(200000000, trajectory);
+    seq_maker.add_trajectory(200000001, ais::TrajectoryView{trajectory}.first(2));
+    REQUIRE(seq_maker.run(false).size() == 1);
+
+    REQUIRE(stats::get(stats::Counter::duplicates_removed) == 1);
+    REQUIRE(stats::get(stats::Counter::points_filtered) == 0);
+    REQUIRE(stats::get(stats::Counter::trajectories_processed) == 1);
+    REQUIRE(stats::get(stats::Counter::trajectories_skipped) == 1);
+    REQUIRE(stats::get(stats::Counter::sequences_emitted) == 2);
+    REQUIRE(stats::get(stats::Counter::sequences_rejected_v_min) == 0);
+
+    auto slow_args = split_args;
+    slow_args.v_min = 1e6;   // NOLINT
+    REQUIRE(split(ais::TrajectoryView{trajectory}.first(12), slow_args).empty());
+    REQUIRE(stats::get(stats::Counter::sequences_rejected_v_min) == 2);
+
+    const auto path = temp_path("stats.json");
+    stats::write_json(path);
+    std::string json(std::filesystem::file_size(path), '\0');
+    std::ifstream f(path);
+    f.read(json.data(), static_cast<std::streamsize>(json.size()));
+    for (const auto* key : {"\"stages\"",
+                            "\"split\": {\"wall_s\": ",
+                            "\"counters\"",
+                            "\"rows_rejected_mmsi\": 1",
+                            "\"sequences_emitted\": 2",
+                            "\"peak_rss_bytes\""}) {
+        REQUIRE(json.find(key) != std::string::npos);
+    }
+    std::filesystem::remove(path);
+
+    // positions of a stream with the time of their predecessor, or behind the reorder window
+    stats::reset();
+    SequenceStreamer streamer{split_args, stream_args{}, [](auto, auto) {}};
+    for (auto t : {10U, 10U, 5U, 15U}) {
+        streamer.push(200000000, ais::Position{.t = t, .x = ais::Point{}});
+    }
+    streamer.finish();
+    REQUIRE(stats::get(stats::Counter::duplicates_removed) == 1);
+    REQUIRE(stats::get(stats::Counter::positions_dropped) == 1);
+
+    stats::reset();
+    REQUIRE(stats::get(stats::Counter::rows_parsed) == 0);
+
+    // recording is a no-op once disabled
+    stats::disable();
+    REQUIRE(parse_ais_lines(lines, ", ").size() == 1);
+    REQUIRE(stats::get(stats::Counter::rows_parsed) == 0);
+}